@@ -0,0 +1,157 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSTLMeshBatchReader_h
+#define itkSTLMeshBatchReader_h
+
+#include "itkObject.h"
+#include "itkSTLMeshIO.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class STLMeshBatchReader
+ * \brief Read a list of STL files concurrently.
+ *
+ * The files are parsed in parallel on the ITK thread pool, by a pool of
+ * STLMeshIO instances that keep their buffers from one file to the next.
+ * The result is either one mesh per file, or, when MergeParts is On, a
+ * single mesh that concatenates all the parts and stores the index of the
+ * part of every triangle as its cell data. The points shared by several
+ * parts are merged when WeldAcrossParts is On.
+ *
+ * A file that cannot be read does not abort the batch: its error message
+ * is recorded, and the other files are still read.
+ *
+ * \ingroup IOFilters
+ * \ingroup IOMeshSTL
+ */
+template <typename TOutputMesh>
+class ITK_TEMPLATE_EXPORT STLMeshBatchReader : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(STLMeshBatchReader);
+
+  /** Standard class type aliases. */
+  using Self = STLMeshBatchReader;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(STLMeshBatchReader, Object);
+
+  using OutputMeshType = TOutputMesh;
+  using OutputMeshPointer = typename OutputMeshType::Pointer;
+
+  using FileNamesContainerType = std::vector<std::string>;
+
+  /** Set/Get the names of the files to read. */
+  void
+  SetFileNames(const FileNamesContainerType & fileNames)
+  {
+    this->m_FileNames = fileNames;
+    this->Modified();
+  }
+  itkGetConstReferenceMacro(FileNames, FileNamesContainerType);
+
+  /** Set/Get whether the parts are merged into a single mesh, with the index
+   * of the part of each triangle stored as cell data. Off by default. */
+  itkSetMacro(MergeParts, bool);
+  itkGetConstMacro(MergeParts, bool);
+  itkBooleanMacro(MergeParts);
+
+  /** Set/Get whether points with identical coordinates in different parts
+   * are merged into a single point of the merged mesh. Only used when
+   * MergeParts is On. Off by default. */
+  itkSetMacro(WeldAcrossParts, bool);
+  itkGetConstMacro(WeldAcrossParts, bool);
+  itkBooleanMacro(WeldAcrossParts);
+
+  /** Read all the files. */
+  void
+  Update();
+
+  /** Get the mesh read from the file of the given index. Returns nullptr
+   * when the file could not be read, or when MergeParts is On. */
+  OutputMeshType *
+  GetOutput(SizeValueType fileIndex) const;
+
+  /** Get the mesh that merges all the parts. Only available when MergeParts
+   * is On. */
+  OutputMeshType *
+  GetMergedOutput() const
+  {
+    return this->m_MergedOutput.GetPointer();
+  }
+
+  /** Get the error message of the file of the given index, empty when the
+   * file was read successfully. */
+  const std::string &
+  GetErrorMessage(SizeValueType fileIndex) const;
+
+  /** Get the number of files that could not be read. */
+  SizeValueType
+  GetNumberOfFailures() const;
+
+protected:
+  STLMeshBatchReader() = default;
+  ~STLMeshBatchReader() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  /** Welded points and triangles of one file. */
+  struct PartType
+  {
+    std::vector<float>        m_Points;
+    std::vector<unsigned int> m_Triangles;
+  };
+
+  static void
+  ReadPart(STLMeshIO * meshIO, const std::string & fileName, PartType & part);
+
+  static OutputMeshPointer
+  CreateMesh(const PartType & part);
+
+  OutputMeshPointer
+  CreateMergedMesh(const std::vector<PartType> & parts) const;
+
+  FileNamesContainerType m_FileNames;
+
+  bool m_MergeParts{ false };
+  bool m_WeldAcrossParts{ false };
+
+  std::vector<OutputMeshPointer> m_Outputs;
+  OutputMeshPointer              m_MergedOutput;
+  std::vector<std::string>       m_ErrorMessages;
+
+  std::vector<STLMeshIO::Pointer> m_MeshIOPool;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkSTLMeshBatchReader.hxx"
+#endif
+
+#endif // itkSTLMeshBatchReader_h
@@ -0,0 +1,320 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSTLMeshBatchReader_hxx
+#define itkSTLMeshBatchReader_hxx
+
+#include "itkMultiThreaderBase.h"
+#include "itkTriangleCell.h"
+
+#include <array>
+#include <map>
+#include <mutex>
+
+namespace itk
+{
+
+template <typename TOutputMesh>
+void
+STLMeshBatchReader<TOutputMesh>::Update()
+{
+  const SizeValueType numberOfFiles = this->m_FileNames.size();
+
+  std::vector<PartType> parts(numberOfFiles);
+
+  this->m_Outputs.assign(numberOfFiles, nullptr);
+  this->m_MergedOutput = nullptr;
+  this->m_ErrorMessages.assign(numberOfFiles, std::string());
+
+  //
+  // Each file is parsed, and converted to a mesh unless the parts are
+  // merged, by its own work item. Failures are recorded per file. The work
+  // items borrow their STLMeshIO from a pool, so that the buffers of every
+  // instance are reused from file to file, and from one Update() to the
+  // next.
+  //
+  std::mutex meshIOPoolMutex;
+
+  MultiThreaderBase::Pointer multiThreader = MultiThreaderBase::New();
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfFiles,
+    [&](SizeValueType fileIndex) {
+      STLMeshIO::Pointer meshIO;
+      {
+        const std::lock_guard<std::mutex> lock(meshIOPoolMutex);
+        if (this->m_MeshIOPool.empty())
+        {
+          meshIO = STLMeshIO::New();
+        }
+        else
+        {
+          meshIO = this->m_MeshIOPool.back();
+          this->m_MeshIOPool.pop_back();
+        }
+      }
+
+      try
+      {
+        ReadPart(meshIO, this->m_FileNames[fileIndex], parts[fileIndex]);
+
+        if (!this->m_MergeParts)
+        {
+          this->m_Outputs[fileIndex] = CreateMesh(parts[fileIndex]);
+          parts[fileIndex] = PartType();
+        }
+      }
+      catch (const ExceptionObject & exception)
+      {
+        this->m_ErrorMessages[fileIndex] = exception.GetDescription();
+        parts[fileIndex] = PartType();
+      }
+      catch (const std::exception & exception)
+      {
+        this->m_ErrorMessages[fileIndex] = exception.what();
+        parts[fileIndex] = PartType();
+      }
+
+      const std::lock_guard<std::mutex> lock(meshIOPoolMutex);
+      this->m_MeshIOPool.push_back(meshIO);
+    },
+    nullptr);
+
+  if (this->m_MergeParts)
+  {
+    this->m_MergedOutput = this->CreateMergedMesh(parts);
+  }
+}
+
+
+template <typename TOutputMesh>
+void
+STLMeshBatchReader<TOutputMesh>::ReadPart(STLMeshIO * meshIO, const std::string & fileName, PartType & part)
+{
+  if (!meshIO->CanReadFile(fileName.c_str()))
+  {
+    itkGenericExceptionMacro("Unable to read file\n"
+                             "inputFilename= "
+                             << fileName);
+  }
+
+  meshIO->SetFileName(fileName);
+  meshIO->ReadMeshInformation();
+
+  // When the parsing is deferred, the number of points is only an upper
+  // bound until the points are read.
+  part.m_Points.resize(3 * meshIO->GetNumberOfPoints());
+  meshIO->ReadPoints(part.m_Points.data());
+  part.m_Points.resize(3 * meshIO->GetNumberOfPoints());
+
+  //
+  // Keep only the three point Ids of every cell of the buffer, which holds
+  // the cell type, the number of points and the point Ids.
+  //
+  std::vector<unsigned int> cells(meshIO->GetCellBufferSize());
+  meshIO->ReadCells(cells.data());
+
+  const SizeValueType numberOfCells = meshIO->GetNumberOfCells();
+
+  part.m_Triangles.resize(3 * numberOfCells);
+  for (SizeValueType c = 0; c < numberOfCells; ++c)
+  {
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+      part.m_Triangles[3 * c + k] = cells[5 * c + 2 + k];
+    }
+  }
+}
+
+
+template <typename TOutputMesh>
+auto
+STLMeshBatchReader<TOutputMesh>::CreateMesh(const PartType & part) -> OutputMeshPointer
+{
+  using PointType = typename OutputMeshType::PointType;
+  using CellType = typename OutputMeshType::CellType;
+  using CellAutoPointer = typename CellType::CellAutoPointer;
+  using TriangleCellType = TriangleCell<CellType>;
+  using CoordRepType = typename PointType::ValueType;
+
+  OutputMeshPointer mesh = OutputMeshType::New();
+
+  const SizeValueType numberOfPoints = part.m_Points.size() / 3;
+  for (SizeValueType pointId = 0; pointId < numberOfPoints; ++pointId)
+  {
+    PointType point;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      point[i] = static_cast<CoordRepType>(part.m_Points[3 * pointId + i]);
+    }
+    mesh->SetPoint(pointId, point);
+  }
+
+  const SizeValueType numberOfTriangles = part.m_Triangles.size() / 3;
+  for (SizeValueType cellId = 0; cellId < numberOfTriangles; ++cellId)
+  {
+    CellAutoPointer cell;
+    cell.TakeOwnership(new TriangleCellType);
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+      cell->SetPointId(k, part.m_Triangles[3 * cellId + k]);
+    }
+    mesh->SetCell(cellId, cell);
+  }
+
+  return mesh;
+}
+
+
+template <typename TOutputMesh>
+auto
+STLMeshBatchReader<TOutputMesh>::CreateMergedMesh(const std::vector<PartType> & parts) const -> OutputMeshPointer
+{
+  using PointType = typename OutputMeshType::PointType;
+  using CellType = typename OutputMeshType::CellType;
+  using CellAutoPointer = typename CellType::CellAutoPointer;
+  using TriangleCellType = TriangleCell<CellType>;
+  using CoordRepType = typename PointType::ValueType;
+  using CellPixelType = typename OutputMeshType::CellPixelType;
+
+  OutputMeshPointer mesh = OutputMeshType::New();
+
+  // Points already inserted, when welding across parts
+  using STLPointType = std::array<float, 3>;
+  std::map<STLPointType, IdentifierType> weldedPoints;
+
+  std::vector<IdentifierType> pointIds;
+
+  IdentifierType nextPointId = 0;
+  IdentifierType nextCellId = 0;
+
+  for (SizeValueType partIndex = 0; partIndex < parts.size(); ++partIndex)
+  {
+    const PartType & part = parts[partIndex];
+
+    const SizeValueType numberOfPoints = part.m_Points.size() / 3;
+
+    pointIds.resize(numberOfPoints);
+    for (SizeValueType p = 0; p < numberOfPoints; ++p)
+    {
+      STLPointType stlPoint;
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        stlPoint[i] = part.m_Points[3 * p + i];
+      }
+
+      if (this->m_WeldAcrossParts)
+      {
+        const auto inserted = weldedPoints.emplace(stlPoint, nextPointId);
+        pointIds[p] = inserted.first->second;
+        if (!inserted.second)
+        {
+          continue;
+        }
+      }
+      else
+      {
+        pointIds[p] = nextPointId;
+      }
+
+      PointType point;
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        point[i] = static_cast<CoordRepType>(stlPoint[i]);
+      }
+      mesh->SetPoint(nextPointId++, point);
+    }
+
+    const SizeValueType numberOfTriangles = part.m_Triangles.size() / 3;
+    for (SizeValueType t = 0; t < numberOfTriangles; ++t)
+    {
+      CellAutoPointer cell;
+      cell.TakeOwnership(new TriangleCellType);
+      for (unsigned int k = 0; k < 3; ++k)
+      {
+        cell->SetPointId(k, pointIds[part.m_Triangles[3 * t + k]]);
+      }
+      mesh->SetCell(nextCellId, cell);
+      mesh->SetCellData(nextCellId, static_cast<CellPixelType>(partIndex));
+      ++nextCellId;
+    }
+  }
+
+  return mesh;
+}
+
+
+template <typename TOutputMesh>
+auto
+STLMeshBatchReader<TOutputMesh>::GetOutput(SizeValueType fileIndex) const -> OutputMeshType *
+{
+  if (fileIndex >= this->m_Outputs.size())
+  {
+    itkExceptionMacro("Requested output " << fileIndex << " but only " << this->m_Outputs.size()
+                                          << " files were read.");
+  }
+
+  return this->m_Outputs[fileIndex].GetPointer();
+}
+
+
+template <typename TOutputMesh>
+const std::string &
+STLMeshBatchReader<TOutputMesh>::GetErrorMessage(SizeValueType fileIndex) const
+{
+  if (fileIndex >= this->m_ErrorMessages.size())
+  {
+    itkExceptionMacro("Requested error message " << fileIndex << " but only " << this->m_ErrorMessages.size()
+                                                 << " files were read.");
+  }
+
+  return this->m_ErrorMessages[fileIndex];
+}
+
+
+template <typename TOutputMesh>
+SizeValueType
+STLMeshBatchReader<TOutputMesh>::GetNumberOfFailures() const
+{
+  SizeValueType numberOfFailures = 0;
+  for (const std::string & message : this->m_ErrorMessages)
+  {
+    if (!message.empty())
+    {
+      ++numberOfFailures;
+    }
+  }
+  return numberOfFailures;
+}
+
+
+template <typename TOutputMesh>
+void
+STLMeshBatchReader<TOutputMesh>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "FileNames: " << this->m_FileNames.size() << " files" << std::endl;
+  os << indent << "MergeParts: " << (this->m_MergeParts ? "On" : "Off") << std::endl;
+  os << indent << "WeldAcrossParts: " << (this->m_WeldAcrossParts ? "On" : "Off") << std::endl;
+  os << indent << "NumberOfFailures: " << this->GetNumberOfFailures() << std::endl;
+  os << indent << "MeshIOPool: " << this->m_MeshIOPool.size() << " instances" << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkSTLMeshBatchReader_hxx
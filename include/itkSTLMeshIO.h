@@ -22,8 +22,16 @@
 
 #include "itkMeshIOBase.h"
 
+#include <algorithm>
+#include <array>
 #include <fstream>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <memory>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace itk
 {
@@ -52,6 +60,18 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro(STLMeshIO, MeshIOBase);
 
+  /** Type used to represent the point coordinates, STL stores them as
+   * 32-bit floats. */
+  using PointValueType = float;
+  using PointType = Point<PointValueType, 3>;
+
+  /** Type of the bounds of a region: (xmin, xmax, ymin, ymax, zmin, zmax). */
+  using BoundsType = FixedArray<double, 6>;
+
+  /** Type of a callable that decides whether a triangle is kept on read. It
+   * is invoked concurrently from several threads. */
+  using TrianglePredicateType = std::function<bool(const PointType &, const PointType &, const PointType &)>;
+
   /**-------- This part of the interfaces deals with reading data. ----- */
 
   /** Determine if the file can be read with this MeshIO implementation.
@@ -70,7 +90,14 @@ public:
   void
   ReadMeshInformation() override;
 
-  /** Stores the point data into the memory buffer provided. */
+  /** Stores the point data into the memory buffer provided, as coordinates
+   * of the point component type: FLOAT, the type stored in STL files, by
+   * default, or DOUBLE when set with SetPointComponentType() before
+   * reading, so that meshes of double coordinates are filled without an
+   * intermediate float buffer. Other types are reset to FLOAT by
+   * ReadMeshInformation(). The MeshIO cannot know the coordinate type of
+   * the mesh being filled, so callers of MeshFileReader with double
+   * coordinates have to opt in with SetPointComponentType(DOUBLE). */
   void
   ReadPoints(void * buffer) override;
 
@@ -78,6 +105,14 @@ public:
   void
   ReadCells(void * buffer) override;
 
+  /** Stores the point ids of the triangles into the memory buffer
+   * provided, as packed triplets without the cell type and number of
+   * points of the ReadCells() layout. The component type of the buffer is
+   * one of UINT, ULONG or ULONGLONG. Together with ReadPoints(), this fills
+   * (N,3) point and (M,3) triangle arrays directly. */
+  void
+  ReadTriangles(void * buffer, IOComponentEnum componentType);
+
   /** Indicates whether ReadPoints() should be called. */
   bool
   GetUpdatePoints() const override;
@@ -86,6 +121,305 @@ public:
   bool
   GetUpdateCells() const override;
 
+  /** Set/Get whether the parsing of binary files is deferred. When On,
+   * ReadMeshInformation() only reads the 84-byte header of a binary file;
+   * the triangles are decoded and their points merged by the first call to
+   * ReadPoints(), ReadCells() or ReadTriangles(). Until then, the number of
+   * cells and the cell buffer size are those of all the triangles of the
+   * header, and the number of points is three times the number of
+   * triangles: upper bounds that are enough to allocate the buffers of
+   * these methods, as MeshFileReader does. The exact numbers are published
+   * once the triangles are decoded. ASCII files do not store the number of
+   * triangles and are always parsed by ReadMeshInformation(). Off by
+   * default. */
+  itkSetMacro(DeferParsing, bool);
+  itkGetConstMacro(DeferParsing, bool);
+  itkBooleanMacro(DeferParsing);
+
+  /** Set/Get whether only the points are read. The vertices of the
+   * triangles are welded as usual, but the triangles are not stored:
+   * GetUpdateCells() returns false, the number of cells is 0, and
+   * ReadCells() and ReadTriangles() leave their buffer untouched. This
+   * saves the memory of the triangles and the packing of the cell buffer
+   * for point-set pipelines. ComputeEdgeAdjacency finds no edge, and the
+   * welded mesh cache is not used. Off by default. */
+  itkSetMacro(ReadPointsOnly, bool);
+  itkGetConstMacro(ReadPointsOnly, bool);
+  itkBooleanMacro(ReadPointsOnly);
+
+  /** Set/Get whether files are read through the direct I/O backend. On
+   * Linux, the file is opened with O_DIRECT, so that it does not fill the
+   * page cache, and its aligned 1 MiB blocks are read ahead with pread()
+   * by a few threads shared by all the readers of the process, so that
+   * several requests are queued on the device while the ASCII or binary
+   * decoder consumes the current block. On file systems that refuse O_DIRECT, the blocks are
+   * read through the page cache instead and their pages are dropped once
+   * decoded. Elsewhere, the file is read through a std::filebuf as when
+   * Off, which is the default. */
+  itkSetMacro(UseDirectRead, bool);
+  itkGetConstMacro(UseDirectRead, bool);
+  itkBooleanMacro(UseDirectRead);
+
+  /** Set/Get whether geometric statistics are accumulated while the
+   * triangles are decoded, so that no second pass over the mesh is needed.
+   * When On, the following entries are stored in the MetaDataDictionary of
+   * this object once the triangles have been read:
+   *
+   *   "STL_BoundingBox"                  std::vector<double> with the bounds
+   *                                      (xmin, xmax, ymin, ymax, zmin, zmax)
+   *   "STL_SurfaceArea"                  double, total area of the triangles
+   *   "STL_Volume"                       double, signed volume enclosed by the
+   *                                      triangles (divergence theorem)
+   *   "STL_NumberOfDegenerateTriangles"  SizeValueType, triangles of zero area
+   *
+   * Off by default. */
+  itkSetMacro(ComputeStatistics, bool);
+  itkGetConstMacro(ComputeStatistics, bool);
+  itkBooleanMacro(ComputeStatistics);
+
+  /** Set/Get whether degenerate triangles are dropped while reading, before
+   * their points are merged. A triangle is degenerate when its area is at
+   * most DegenerateAreaThreshold; triangles with repeated points have a
+   * zero area. The number of dropped triangles is stored in the
+   * MetaDataDictionary as "STL_NumberOfRemovedDegenerateTriangles"
+   * (SizeValueType). Off by default. */
+  itkSetMacro(RemoveDegenerateTriangles, bool);
+  itkGetConstMacro(RemoveDegenerateTriangles, bool);
+  itkBooleanMacro(RemoveDegenerateTriangles);
+
+  /** Set/Get the area at or below which a triangle is degenerate. 0 by
+   * default, so that only the triangles of zero area are dropped. */
+  itkSetClampMacro(DegenerateAreaThreshold, double, 0.0, NumericTraits<double>::max());
+  itkGetConstMacro(DegenerateAreaThreshold, double);
+
+  /** Set/Get whether duplicate triangles are dropped while reading. Once
+   * the points of a triangle are merged, its sorted point Ids are looked up
+   * in a hash set of the triangles kept so far, so that a facet repeated
+   * with the same or the opposite orientation is only kept once. The
+   * number of dropped triangles is stored in the MetaDataDictionary as
+   * "STL_NumberOfRemovedDuplicateTriangles" (SizeValueType). Off by
+   * default. */
+  itkSetMacro(RemoveDuplicateTriangles, bool);
+  itkGetConstMacro(RemoveDuplicateTriangles, bool);
+  itkBooleanMacro(RemoveDuplicateTriangles);
+
+  /** Set/Get whether the edge adjacency of the triangles is computed once
+   * they are read, see GetHalfEdgeNeighbors(). The half-edges are sorted by
+   * edge in parallel, and the number of edges on the boundary and of
+   * non-manifold edges, shared by more than two triangles, are stored in
+   * the MetaDataDictionary as "STL_NumberOfBoundaryEdges" and
+   * "STL_NumberOfNonManifoldEdges" (SizeValueType). Off by default. */
+  itkSetMacro(ComputeEdgeAdjacency, bool);
+  itkGetConstMacro(ComputeEdgeAdjacency, bool);
+  itkBooleanMacro(ComputeEdgeAdjacency);
+
+  /** Values of GetHalfEdgeNeighbors() for the half-edges without neighbor. */
+  static constexpr IdentifierType BoundaryHalfEdge = std::numeric_limits<IdentifierType>::max();
+  static constexpr IdentifierType NonManifoldHalfEdge = BoundaryHalfEdge - 1;
+
+  using HalfEdgeNeighborsType = std::vector<IdentifierType>;
+
+  /** Get the edge adjacency of the triangles computed when
+   * ComputeEdgeAdjacency is On, once the triangles are decoded: by
+   * ReadMeshInformation(), or by the first call to ReadPoints(), ReadCells()
+   * or ReadTriangles() when the parsing is deferred. The half-edge 3 t + k
+   * goes from point k to point (k + 1) % 3 of triangle t; its entry is the
+   * half-edge of the neighbor triangle across the same edge, BoundaryHalfEdge
+   * when there is none, or NonManifoldHalfEdge when the edge is shared by
+   * more than two triangles. */
+  const HalfEdgeNeighborsType &
+  GetHalfEdgeNeighbors() const;
+
+  /** Set/Get whether the points and the triangles are reordered along a
+   * Morton (Z-order) space-filling curve over the bounding box of the mesh.
+   * By default the point Ids follow the order in which the points first
+   * appear in the file; when On, neighbouring points and triangles get
+   * neighbouring Ids, which improves the memory locality of the filters
+   * that traverse the mesh. The topology of the mesh is not changed.
+   * Off by default. */
+  itkSetMacro(ReorderForLocality, bool);
+  itkGetConstMacro(ReorderForLocality, bool);
+  itkBooleanMacro(ReorderForLocality);
+
+  /** Set/Get the axis-aligned region of interest used when
+   * UseRegionOfInterest is On. Only the triangles that intersect the region
+   * are kept; the other ones are discarded while decoding, before their
+   * points are merged, so that the memory used by the reader depends on the
+   * size of the region rather than on the size of the file. */
+  itkSetMacro(RegionOfInterest, BoundsType);
+  itkGetConstReferenceMacro(RegionOfInterest, BoundsType);
+
+  /** Set/Get whether the triangles are restricted to the RegionOfInterest.
+   * Off by default. */
+  itkSetMacro(UseRegionOfInterest, bool);
+  itkGetConstMacro(UseRegionOfInterest, bool);
+  itkBooleanMacro(UseRegionOfInterest);
+
+  /** Set/Get whether a spatial index is used for binary files. The index
+   * is stored next to the STL file, with the .stlidx extension, and maps
+   * tiles of a uniform grid over the mesh to the ranges of triangle records
+   * whose centroid falls in the tile. It is built on the first read of the
+   * file, and rebuilt whenever the size or the modification time of the
+   * file change. When UseRegionOfInterest is On, only the records of the
+   * tiles that overlap the region are read from disk. Off by default. */
+  itkSetMacro(UseSpatialIndex, bool);
+  itkGetConstMacro(UseSpatialIndex, bool);
+  itkBooleanMacro(UseSpatialIndex);
+
+  /** Set/Get whether the welded mesh is cached next to the STL file, with
+   * the .stlcache extension. After a complete read, the unique points and
+   * the point ids of the triangles are stored there as flat arrays behind
+   * a fixed-size header; later reads of the same, unmodified file load
+   * them directly instead of parsing the file and merging its points. The
+   * cache is bypassed by reads that use a RegionOfInterest, a
+   * TrianglePredicate or UseExternalMemoryWeld, and meshes of more than
+   * 2^32 points are not cached. Off by default. */
+  itkSetMacro(UseWeldedMeshCache, bool);
+  itkGetConstMacro(UseWeldedMeshCache, bool);
+  itkBooleanMacro(UseWeldedMeshCache);
+
+  /** Get whether the mesh of the last read was loaded from the welded mesh
+   * cache instead of being parsed from the STL file. */
+  itkGetConstMacro(ReadFromWeldedMeshCache, bool);
+
+  /** Set/Get whether the points of binary files are welded out of core,
+   * for meshes whose welding index does not fit in memory. The vertices
+   * are sorted by coordinates in runs of at most WeldMemoryBudget bytes,
+   * which are spilled to the ScratchDirectory and merged, a bounded number
+   * of scratch files being open at any time; the unique points and the
+   * remapped point ids of the triangles are written to two files of that
+   * directory, and ReadPoints() and ReadCells() stream them into their
+   * buffers. The points are ordered by coordinates instead of by
+   * first appearance. This mode cannot be combined with
+   * RemoveDuplicateTriangles, ReorderForLocality or ComputeEdgeAdjacency,
+   * and ASCII files are not supported. Off by default. */
+  itkSetMacro(UseExternalMemoryWeld, bool);
+  itkGetConstMacro(UseExternalMemoryWeld, bool);
+  itkBooleanMacro(UseExternalMemoryWeld);
+
+  /** Set/Get the size of the cells of the uniform grid used to read a
+   * decimated preview of the mesh. The vertices are clustered while the
+   * file is decoded: every vertex is mapped to the grid cell that contains
+   * it, the triangles that collapse or repeat another one are discarded,
+   * and each cell becomes one point, at the mean of its vertices. With
+   * RemoveDuplicateTriangles, the repeated triangles are counted in
+   * STL_NumberOfRemovedDuplicateTriangles. A preview read takes precedence
+   * over UseExternalMemoryWeld, and the statistics describe the full
+   * resolution triangles. 0, the default, reads the mesh
+   * at full resolution unless PreviewTargetNumberOfTriangles is set. */
+  itkSetClampMacro(PreviewCellSize, double, 0.0, NumericTraits<double>::max());
+  itkGetConstMacro(PreviewCellSize, double);
+
+  /** Set/Get the approximate number of triangles of a preview read. The
+   * cells of the grid, which start at PreviewCellSize or else at about the
+   * size of the first triangle, are doubled whenever the number of clusters
+   * exceeds half of this number, so that the memory used stays in
+   * proportion to the preview. 0, the default, disables the limit. */
+  itkSetMacro(PreviewTargetNumberOfTriangles, SizeValueType);
+  itkGetConstMacro(PreviewTargetNumberOfTriangles, SizeValueType);
+
+  /** Set/Get the memory, in bytes, used by each sorted run and bucket of
+   * the external memory weld. 1 GiB by default. */
+  itkSetClampMacro(WeldMemoryBudget, SizeValueType, 4096, NumericTraits<SizeValueType>::max());
+  itkGetConstMacro(WeldMemoryBudget, SizeValueType);
+
+  /** Set/Get the directory of the temporary files of the external memory
+   * weld. The directory of the STL file is used when empty, which is the
+   * default. */
+  itkSetStringMacro(ScratchDirectory);
+  itkGetStringMacro(ScratchDirectory);
+
+  /** Get the files written by the external memory weld: the coordinates
+   * of the unique points as float triplets, and the point ids of the
+   * triangles as uint32 triplets, or uint64 triplets for more than 2^32
+   * points, in the byte order of the system. They are removed by the next
+   * read, and when this object is destroyed. */
+  itkGetConstReferenceMacro(ExternalWeldPointsFileName, std::string);
+  itkGetConstReferenceMacro(ExternalWeldTrianglesFileName, std::string);
+
+  /** Set/Get a predicate that decides which triangles are kept on read, in
+   * addition to the RegionOfInterest. An empty predicate keeps every
+   * triangle. */
+  void
+  SetTrianglePredicate(const TrianglePredicateType & predicate);
+  const TrianglePredicateType &
+  GetTrianglePredicate() const
+  {
+    return this->m_TrianglePredicate;
+  }
+
+  /** Convert the STL file FileName, or the InputBuffer, to an STL file of
+   * the given type, written to outputFileName, or to the OutputBuffer when
+   * it is set. The facets are copied one block at a time, in file order,
+   * and keep the normals and the attribute byte counts stored in the file;
+   * ASCII files hold no attribute byte count, and those of the facets read
+   * from them are 0. No mesh is built, no point is welded, and the memory
+   * used does not depend on the size of the file. The calling thread parses
+   * the facets while another thread formats and writes the previous block.
+   * Returns the number of facets. */
+  SizeValueType
+  Transcode(const std::string & outputFileName, IOFileEnum outputFileType);
+
+  /** Set the memory from which the file is read, instead of FileName, or
+   * nullptr to read FileName again. The memory holds the whole content of
+   * an ASCII or binary STL file; the records of binary files are decoded
+   * where they are, without being copied. The memory must stay valid until
+   * the mesh has been read, deferred parsing included. The welded mesh
+   * cache and the spatial index, which are stored next to FileName, are
+   * not used. */
+  void
+  SetInputBuffer(const void * buffer, SizeValueType size);
+  const void *
+  GetInputBuffer() const
+  {
+    return this->m_InputBuffer;
+  }
+  itkGetConstMacro(InputBufferSize, SizeValueType);
+
+  /** Set/Get the number of binary files among which the triangles are
+   * split on write. When greater than 1, the file FileName is not written:
+   * shard k is the complete binary STL file GetShardFileName(k), and the
+   * manifest GetShardManifestFileName() lists, one line per shard, its
+   * file name, its number of triangles and the bounds of its triangles.
+   * The shards are written concurrently, each one by its own work unit.
+   * Not used for ASCII files, nor with an OutputBuffer. 1 by default. */
+  itkSetClampMacro(NumberOfShards, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(NumberOfShards, unsigned int);
+
+  /** Set/Get how the triangles are split among the shards. With -1, the
+   * default, every shard holds an equal share of consecutive triangles.
+   * With 0, 1 or 2, the triangles are sorted along the x, y or z axis by
+   * the coordinate of their centroid, and every shard holds an equal share
+   * of them: a slab of the mesh along that axis. The triangles of a shard
+   * keep their order in the mesh. */
+  itkSetClampMacro(ShardAxis, int, -1, 2);
+  itkGetConstMacro(ShardAxis, int);
+
+  /** Get the name of a shard written when NumberOfShards is greater than
+   * 1: "mesh.<k>.stl" for the FileName "mesh.stl". */
+  std::string
+  GetShardFileName(unsigned int shard) const;
+
+  /** Get the name of the manifest of the shards: "mesh.stlshards" for the
+   * FileName "mesh.stl". */
+  std::string
+  GetShardManifestFileName() const;
+
+  /** Set/Get the buffer to which the file is written, instead of FileName,
+   * or nullptr to write FileName again. WriteMeshInformation() clears the
+   * buffer, which then grows as the triangles are written. The memory
+   * mapped writer, the background writer and AppendToFile do not apply. */
+  itkSetMacro(OutputBuffer, std::vector<char> *);
+  itkGetConstMacro(OutputBuffer, std::vector<char> *);
+
+  /** Release the memory held by the welded points, the point index and the
+   * triangles of the last file read. Each read clears these buffers but
+   * keeps their capacity, so that an instance reused for many files stops
+   * allocating once it has read the largest of them; call this method to
+   * give that memory back between batches. */
+  void
+  ReleaseMemory();
+
   /** STL files do not carry information in points or cells.
    * Therefore the following two methods are implemented as null
    * operations. */
@@ -139,6 +473,13 @@ public:
   void
   WriteCells(void * buffer) override;
 
+  /** Write triangles given as packed triplets of point ids, of component
+   * type UINT, ULONG or ULONGLONG, instead of the WriteCells() layout. The
+   * records are encoded directly from the buffer, which is not copied. The
+   * number of cells must be set beforehand, as for WriteCells(). */
+  void
+  WriteTriangles(void * buffer, IOComponentEnum componentType);
+
   /** STL files do not carry information in points or cells.
    * Therefore the following two methods are implemented as null
    * operations. */
@@ -147,9 +488,50 @@ public:
   void
   WriteCellData(void * itkNotUsed(buffer)) override{};
 
+  /** Set/Get whether quadrilateral and polygon cells are triangulated on
+   * write. Each polygon of n points is split into a fan of n - 2 triangles
+   * around its first point, which is exact for convex polygons. The number
+   * of triangles, and the position of the triangles of every cell in the
+   * file, are computed with a parallel prefix sum before any triangle is
+   * written. When Off, cells other than triangles raise an exception. Off
+   * by default. */
+  itkSetMacro(TriangulatePolygons, bool);
+  itkGetConstMacro(TriangulatePolygons, bool);
+  itkBooleanMacro(TriangulatePolygons);
+
+  /** Set/Get whether the triangles are appended to an existing binary
+   * file instead of replacing it. The existing header and size are
+   * validated, the new 50-byte records are written after the last one, and
+   * the number of triangles in the header is patched in place, so that
+   * each write costs time proportional to the new triangles only. Files
+   * that do not exist yet are written as usual; ASCII files are always
+   * replaced. Appending uses the stream writer, even when
+   * UseMemoryMappedWriter is on. Off by default. */
+  itkSetMacro(AppendToFile, bool);
+  itkGetConstMacro(AppendToFile, bool);
+  itkBooleanMacro(AppendToFile);
+
+  /** Set/Get whether binary files are written through a memory mapping.
+   * The file is preallocated to its final size, 84 + 50 bytes per
+   * triangle, mapped in memory, and its records are computed and stored in
+   * parallel, each one at its own offset; Write() then synchronizes the
+   * mapping with the disk once. Only available on POSIX systems: elsewhere,
+   * and for ASCII files, the stream writer is used. Off by default. */
+  itkSetMacro(UseMemoryMappedWriter, bool);
+  itkGetConstMacro(UseMemoryMappedWriter, bool);
+  itkBooleanMacro(UseMemoryMappedWriter);
+
+  /** Set/Get whether the serialized triangles are handed to a background
+   * thread that flushes them to disk while the cell loop keeps formatting
+   * the next records. Any I/O error raised by that thread is reported as an
+   * exception by Write(). Off by default. */
+  itkSetMacro(UseBackgroundWriter, bool);
+  itkGetConstMacro(UseBackgroundWriter, bool);
+  itkBooleanMacro(UseBackgroundWriter);
+
 protected:
   STLMeshIO();
-  ~STLMeshIO() override = default;
+  ~STLMeshIO() override;
 
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
@@ -185,30 +567,195 @@ protected:
     }
   }
 
+  /** Templated version of read points method, that stores the coordinates
+   * in the type used by the caller. */
+  template <typename TCoordinate>
+  void
+  ReadPointsTyped(TCoordinate * buffer)
+  {
+    if (this->m_ReadFromWeldedMeshCache)
+    {
+      std::copy(this->m_CachedPoints.begin(), this->m_CachedPoints.end(), buffer);
+      return;
+    }
+
+    if (!this->m_ExternalWeldPointsFileName.empty())
+    {
+      this->ReadExternalWeldPoints([&buffer](const float * coordinates, SizeValueType numberOfPoints) {
+        buffer = std::copy_n(coordinates, 3 * numberOfPoints, buffer);
+      });
+      return;
+    }
+
+    for (const PointType & point : this->m_WeldedPoints)
+    {
+      buffer = std::copy_n(point.GetDataPointer(), 3, buffer);
+    }
+  }
+
+  template <typename TPointId>
+  void
+  ReadTrianglesTyped(TPointId * buffer)
+  {
+    if (this->m_ReadFromWeldedMeshCache)
+    {
+      std::copy(this->m_CachedTriangles.begin(), this->m_CachedTriangles.end(), buffer);
+      return;
+    }
+
+    if (!this->m_ExternalWeldTrianglesFileName.empty())
+    {
+      this->ReadExternalWeldTriangles([&buffer](const uint64_t * pointIds, SizeValueType numberOfTriangles) {
+        buffer = std::transform(pointIds, pointIds + 3 * numberOfTriangles, buffer, [](uint64_t pointId) {
+          return static_cast<TPointId>(pointId);
+        });
+      });
+      return;
+    }
+
+    const SizeValueType numberOfTriangles = this->m_CellsVector.size();
+    for (SizeValueType t = 0; t < numberOfTriangles; ++t)
+    {
+      const TripletType triangle = this->m_CellsVector[t];
+      *buffer++ = static_cast<TPointId>(triangle.p0);
+      *buffer++ = static_cast<TPointId>(triangle.p1);
+      *buffer++ = static_cast<TPointId>(triangle.p2);
+    }
+  }
+
+  /** Templated version of WriteTriangles(), defined in the .cxx file. */
+  template <typename TPointId>
+  void
+  WriteTrianglesTyped(const TPointId * buffer);
+
+  // Triplet to hold the Ids of points in a triagle as they are being read
+  class TripletType
+  {
+  public:
+    IdentifierType p0;
+    IdentifierType p1;
+    IdentifierType p2;
+  };
+
+  // Point Ids of the triangles, three per triangle. They are stored as
+  // 32-bit integers, and only widened to 64-bit integers once a point Id
+  // does not fit in 32 bits.
+  class CellsVectorType
+  {
+  public:
+    SizeValueType
+    size() const
+    {
+      return (this->m_Wide ? this->m_WideIds.size() : this->m_Ids.size()) / 3;
+    }
+    void
+    reserve(SizeValueType numberOfTriangles);
+    void
+    resize(SizeValueType numberOfTriangles, bool wide);
+    void
+    clear();
+    void
+    swap(CellsVectorType & other) noexcept;
+    void
+    push_back(const TripletType & triangle);
+    TripletType
+    operator[](SizeValueType triangleId) const;
+    // The point Ids must fit in the current width of the storage.
+    void
+    SetTriangle(SizeValueType triangleId, const TripletType & triangle);
+    bool
+    IsWide() const
+    {
+      return this->m_Wide;
+    }
+
+  private:
+    std::vector<uint32_t> m_Ids;
+    std::vector<uint64_t> m_WideIds;
+    bool                  m_Wide{ false };
+  };
+
 
 private:
-  std::ofstream m_OutputStream; // output file
-  std::ifstream m_InputStream;  // input file
+  /** Writer thread that consumes the output chunks, defined in the .cxx file. */
+  class BackgroundWriter;
 
-  std::string m_InputLine; // helper during reading
+  /** Read-ahead buffer over a file opened with O_DIRECT, defined in the .cxx file. */
+  class DirectReadBuffer;
 
-  using PointValueType = float; // type to represent point coordinates
+  /** Stream buffer over the memory set by SetInputBuffer(), defined in the .cxx file. */
+  class MemoryReadBuffer;
+
+  std::ofstream                   m_OutputStream;          // output file
+  std::istream                    m_InputStream{ nullptr }; // input file, over m_InputStreamBuffer
+  std::unique_ptr<std::streambuf> m_InputStreamBuffer;
+  bool                            m_UseDirectRead{ false };
+
+  const char *        m_InputBuffer{ nullptr };
+  SizeValueType       m_InputBufferSize{ 0 };
+  std::vector<char> * m_OutputBuffer{ nullptr };
+
+  std::string m_InputLine; // helper during reading
 
-  using PointType = Point<PointValueType, 3>;
   using VectorType = Vector<PointValueType, 3>;
   using NormalType = CovariantVector<PointValueType, 3>;
 
   using PointContainerType = std::vector<PointType>;
 
+  /** Helper functions to accumulate the serialized output into fixed-size
+   * chunks, and to hand a filled chunk to the stream or to the writer thread. */
+  void
+  WriteToOutput(const char * data, size_t size);
+  void
+  FlushOutputChunk();
+  void
+  FinishOutput();
+
   /** Helper functions to write elements to binary file */
   void
   WriteInt32AsBinary(int32_t value);
+  static void
+  WriteTriangleAsBinary(const PointType & p0, const PointType & p1, const PointType & p2, char * record);
+
+  /** Check the cells to write and count their triangles. When polygons
+   * are triangulated, also store the offset of every cell in the buffer
+   * and the index of its first triangle. */
+  SizeValueType
+  IndexCellsForWriting(const IdentifierType * cellsBuffer);
+
+  /** Write the triangles of a view of the cells to write, either the
+   * buffer of WriteCells() or the packed triplets of WriteTriangles().
+   * The views are defined in the .cxx file. */
+  template <typename TCellView>
+  void
+  WriteTrianglesAsAscii(const TCellView & cells);
+  template <typename TCellView>
   void
-  WriteInt16AsBinary(int16_t value);
+  WriteTrianglesAsBinary(const TCellView & cells, SizeValueType numberOfTriangles);
+
+  /** Helper functions to append triangles to an existing binary file. */
   void
-  WriteNormalAsBinary(const NormalType & normal);
+  OpenOutputForAppending();
   void
-  WritePointAsBinary(const PointType & point);
+  PatchNumberOfTriangles();
+
+  /** Helper functions to write binary files through a memory mapping. */
+  bool
+  UseMemoryMappedOutput() const;
+  template <typename TCellView>
+  void
+  WriteCellsAsMemoryMappedBinary(const TCellView & cells, SizeValueType numberOfTriangles);
+  void
+  FinishMemoryMappedOutput();
+  void
+  ReleaseMemoryMappedOutput();
+
+  /** Helper functions to split binary files into shards. */
+  bool
+  UseShardedOutput() const;
+  template <typename TCellView>
+  void
+  WriteCellsAsShards(const TCellView & cells, SizeValueType numberOfTriangles);
 
   /** Helper functions to read elements from ASCII and BINARY files. */
   void
@@ -216,15 +763,180 @@ private:
   void
   ReadMeshInternalFromBinary();
 
-  /** Helper functions to read elements from binary file */
+  /** Read the given number of triangle records from the current position of
+   * the input stream, either as one block or as a sequence of blocks. */
   void
-  ReadInt32AsBinary(int32_t & value);
+  ReadBlockFromBinary(SizeValueType numberOfTriangles);
   void
-  ReadInt16AsBinary(int16_t & value);
+  ReadTrianglesFromBinary(SizeValueType numberOfTriangles);
+
+  /** Fixed-size header of a spatial index file. */
+  struct SpatialIndexHeaderType
+  {
+    char     m_Magic[8];
+    uint64_t m_FileSize;
+    int64_t  m_ModifiedTime;
+    uint64_t m_NumberOfTriangles;
+    uint64_t m_NumberOfTiles;
+  };
+
+  /** Range of consecutive triangle records of a spatial index tile. */
+  struct SpatialIndexRangeType
+  {
+    uint32_t m_First;
+    uint32_t m_Count;
+  };
+
+  /** Tile of a spatial index: bounds of its triangles, and the ranges of
+   * triangle records assigned to it. All values are stored in the byte
+   * order of the system that built the index. */
+  struct SpatialIndexTileType
+  {
+    float                              m_Bounds[6];
+    std::vector<SpatialIndexRangeType> m_Ranges;
+  };
+
+  using SpatialIndexType = std::vector<SpatialIndexTileType>;
+
+  /** Name of a file stored next to the STL file, with the given extension. */
+  std::string
+  GetCompanionFileName(const char * extension) const;
+
+  /** Functions to manage the spatial index of a binary file. */
+  bool
+  ReadSpatialIndex(SizeValueType numberOfTriangles, SpatialIndexType & index);
+  void
+  BuildSpatialIndex(SizeValueType numberOfTriangles, SpatialIndexType & index);
   void
-  ReadNormalAsBinary(NormalType & normal);
+  WriteSpatialIndex(SizeValueType numberOfTriangles, const SpatialIndexType & index);
   void
-  ReadPointAsBinary(PointType & point);
+  QuerySpatialIndex(const SpatialIndexType & index, std::vector<std::pair<SizeValueType, SizeValueType>> & ranges) const;
+
+  /** Fixed-size header of a welded mesh cache file, followed by the
+   * coordinates of the points as float triplets and the point ids of the
+   * triangles as uint32 triplets, in the byte order of the system that
+   * wrote the cache. */
+  struct WeldedMeshCacheHeaderType
+  {
+    char     m_Magic[8];
+    uint64_t m_FileSize;
+    int64_t  m_ModifiedTime;
+    uint32_t m_FileType;
+    uint32_t m_ReorderedForLocality;
+    uint64_t m_NumberOfPoints;
+    uint64_t m_NumberOfTriangles;
+  };
+
+  /** Functions to manage the welded mesh cache. */
+  bool
+  CanUseWeldedMeshCache() const;
+  bool
+  ReadWeldedMeshCache();
+  void
+  WriteWeldedMeshCache();
+
+  /** Integer coordinates of the grid cell of a cluster. */
+  using ClusterKeyType = std::array<int64_t, 3>;
+
+  struct ClusterKeyHash
+  {
+    size_t
+    operator()(const ClusterKeyType & key) const;
+  };
+
+  using ClusterIdMapType = std::unordered_map<ClusterKeyType, IdentifierType, ClusterKeyHash>;
+
+  /** Functions of the vertex clustering of preview reads. */
+  bool
+  IsPreview() const
+  {
+    return this->m_PreviewCellSize > 0.0 || this->m_PreviewTargetNumberOfTriangles > 0;
+  }
+  void
+  InsertTriangleIntoClusters(const PointType & p0, const PointType & p1, const PointType & p2);
+  IdentifierType
+  FindOrInsertCluster(const ClusterKeyType & key);
+  void
+  CoarsenClusters();
+  void
+  FinishClusters();
+
+  /** Functions of the external memory weld. */
+  void
+  WeldExternally(SizeValueType numberOfTriangles);
+  std::string
+  GetScratchFileName(const std::string & suffix) const;
+  void
+  RemoveExternalWeldFiles();
+  void
+  ReadExternalWeldPoints(
+    const std::function<void(const float * coordinates, SizeValueType numberOfPoints)> & visitor) const;
+  void
+  ReadExternalWeldTriangles(
+    const std::function<void(const uint64_t * pointIds, SizeValueType numberOfTriangles)> & visitor) const;
+
+  /** Open the input file through the backend selected by UseDirectRead,
+   * return false when it cannot be opened. */
+  bool
+  OpenInputStream(std::ios::openmode mode);
+  void
+  CloseInputStream();
+
+  /** Facet of an STL file, as stored in the file. */
+  struct FacetType
+  {
+    float    m_Normal[3];
+    float    m_Vertices[9];
+    uint16_t m_AttributeByteCount;
+  };
+
+  /** Functions used by Transcode() to copy the facets of a file. */
+  void
+  ReadFacetFromAscii(FacetType & facet);
+  void
+  WriteFacets(const FacetType * facets, SizeValueType numberOfFacets, IOFileEnum fileType);
+
+  /** Read the next records of a binary file, return their address. */
+  const char *
+  ReadRecordsFromBinary(SizeValueType numberOfTriangles);
+
+  /** Read the 80-byte header and the number of triangles of a binary file. */
+  int32_t
+  ReadHeaderFromBinary();
+
+  /** Decode the binary file whose parsing was deferred by ReadMeshInformation(). */
+  void
+  ReadDeferredMeshInternal();
+
+  /** Publish the number of points and cells once the triangles are read. */
+  void
+  FinishReadMeshInternal();
+
+  /** Key of a half-edge, used to sort the half-edges by edge. */
+  struct HalfEdgeKeyType
+  {
+    IdentifierType m_Lower;
+    IdentifierType m_Upper;
+    IdentifierType m_HalfEdge;
+  };
+
+  /** Pair the half-edges of the triangles that share an edge. */
+  void
+  BuildHalfEdgeAdjacency();
+
+  /** Renumber the points and sort the triangles along a Morton curve. */
+  void
+  ReorderAlongMortonCurve();
+
+  /** Store the accumulated statistics in the MetaDataDictionary. */
+  void
+  PublishStatistics();
+
+  /** Helper functions to read elements from binary file */
+  void
+  ReadInt32AsBinary(int32_t & value);
+  void
+  ReadPointAsBinary(const char * data, PointType & point);
 
   /** Helper functions to read elements from ASCII files. */
   void
@@ -243,53 +955,180 @@ private:
   /** Functions to create set of points and disambiguate them. */
   void
   InsertPointIntoSet(const PointType & point);
+  void
+  InsertTriangle(const PointType & p0, const PointType & p1, const PointType & p2);
+
+  /** Functions to select the triangles that are kept on read. */
+  void
+  InitializeWeldedMesh();
+  void
+  InitializeTriangleFilter();
+  bool
+  AcceptTriangle(const PointType & p0, const PointType & p1, const PointType & p2) const;
+  bool
+  IsDegenerateTriangle(const PointType & p0, const PointType & p1, const PointType & p2) const;
+  bool
+  TriangleIntersectsRegionOfInterest(const PointType & p0, const PointType & p1, const PointType & p2) const;
 
   PointContainerType m_Points;
 
   unsigned int m_InputLineNumber;
 
-  struct PointCompare
+  // Open-addressing hash index from the coordinates of the welded points
+  // to their Ids, which are positions in m_WeldedPoints. Clearing the index
+  // keeps its slots allocated.
+  class PointIndexType
   {
-    bool
-    operator()(const PointType & p1, const PointType & p2) const
-    {
-      if (p1[0] != p2[0])
-      {
-        return p1[0] < p2[0];
-      }
-      else
-      {
-        if (p1[1] != p2[1])
-        {
-          return p1[1] < p2[1];
-        }
-      }
+  public:
+    // Return the Id of the point, after appending it to the welded points
+    // if it was not found.
+    IdentifierType
+    FindOrInsert(const PointType & point, PointContainerType & weldedPoints);
+    void
+    reserve(SizeValueType numberOfPoints, const PointContainerType & weldedPoints);
+    void
+    clear();
+    void
+    Release();
+    // Replace every Id by newIds[Id], after the welded points were permuted.
+    void
+    Remap(const std::vector<IdentifierType> & newIds);
 
-      return p1[2] < p2[2];
-    }
+  private:
+    static SizeValueType
+    Hash(const PointType & point);
+    void
+    Rehash(SizeValueType numberOfSlots, const PointContainerType & weldedPoints);
+
+    static constexpr IdentifierType EmptySlot = std::numeric_limits<IdentifierType>::max();
+
+    std::vector<IdentifierType> m_Slots;
+    SizeValueType               m_NumberOfPoints{ 0 };
   };
 
-  using PointsMapType = std::map<PointType, IdentifierType, PointCompare>;
+  // Unique points of the file, by Id, and their index.
+  PointContainerType m_WeldedPoints;
+  PointIndexType     m_PointIndex;
 
-  PointsMapType m_PointsMap;
+  TripletType  m_TrianglePointIds;
+  unsigned int m_PointInTriangleCounter;
 
-  // Helper variable to put Ids in points as they are read
-  IdentifierType m_LatestPointId;
+  CellsVectorType m_CellsVector;
 
-  // Triplet to hold the Ids of points in a triagle as they are being read
-  class TripletType
+  // Per-triangle reductions computed while decoding. Partial statistics
+  // of independent ranges of triangles can be combined with Merge().
+  struct StatisticsType
   {
-  public:
-    IdentifierType p0;
-    IdentifierType p1;
-    IdentifierType p2;
+    double        m_Bounds[6];
+    double        m_SurfaceArea;
+    double        m_Volume;
+    SizeValueType m_NumberOfDegenerateTriangles;
+
+    void
+    Initialize();
+    void
+    AddTriangle(const PointType & p0, const PointType & p1, const PointType & p2);
+    // Bounds are kept: only valid for triangles whose points remain in the mesh.
+    void
+    RemoveTriangle(const PointType & p0, const PointType & p1, const PointType & p2);
+    void
+    Merge(const StatisticsType & other);
   };
 
-  TripletType  m_TrianglePointIds;
-  unsigned int m_PointInTriangleCounter;
+  /** Sorted point Ids of a triangle, used to find duplicate triangles. */
+  using TriangleKeyType = std::array<IdentifierType, 3>;
 
-  using CellsVectorType = std::vector<TripletType>;
-  CellsVectorType m_CellsVector;
+  struct TriangleKeyHash
+  {
+    size_t
+    operator()(const TriangleKeyType & key) const;
+  };
+
+  using TriangleKeySetType = std::unordered_set<TriangleKeyType, TriangleKeyHash>;
+
+  bool               m_RemoveDegenerateTriangles{ false };
+  double             m_DegenerateAreaThreshold{ 0.0 };
+  bool               m_RemoveDuplicateTriangles{ false };
+  TriangleKeySetType m_TriangleKeys;
+  SizeValueType      m_NumberOfRemovedDegenerateTriangles{ 0 };
+  SizeValueType      m_NumberOfRemovedDuplicateTriangles{ 0 };
+
+  bool m_ReorderForLocality{ false };
+
+  bool                  m_ComputeEdgeAdjacency{ false };
+  HalfEdgeNeighborsType m_HalfEdgeNeighbors;
+
+  BoundsType            m_RegionOfInterest{};
+  bool                  m_UseRegionOfInterest{ false };
+  double                m_RegionOfInterestCenter[3]{};
+  double                m_RegionOfInterestHalfSize[3]{};
+  TrianglePredicateType m_TrianglePredicate;
+
+  bool m_UseSpatialIndex{ false };
+
+  // Buffers used to decode the binary triangle records
+  std::vector<char>      m_RecordsBuffer;
+  std::vector<PointType> m_VerticesBuffer;
+
+  bool           m_ComputeStatistics{ false };
+  StatisticsType m_Statistics;
+
+  // Serialized output waiting to be written
+  std::vector<char> m_OutputChunk;
+
+  bool                  m_UseWeldedMeshCache{ false };
+  bool                  m_ReadFromWeldedMeshCache{ false };
+  std::vector<float>    m_CachedPoints;
+  std::vector<uint32_t> m_CachedTriangles;
+
+  bool                     m_UseExternalMemoryWeld{ false };
+  SizeValueType            m_WeldMemoryBudget{ SizeValueType{ 1 } << 30 };
+  std::string              m_ScratchDirectory;
+  std::vector<std::string> m_ScratchFileNames;
+  std::string              m_ExternalWeldPointsFileName;
+  std::string              m_ExternalWeldTrianglesFileName;
+  bool                     m_ExternalWeldWideIds{ false };
+
+  // Sum of the coordinates and number of the vertices of a cluster.
+  struct ClusterSumType
+  {
+    double        m_Sum[3];
+    SizeValueType m_Count;
+  };
+
+  double                      m_PreviewCellSize{ 0.0 };
+  SizeValueType               m_PreviewTargetNumberOfTriangles{ 0 };
+  double                      m_ClusterCellSize{ 0.0 };
+  std::vector<ClusterKeyType> m_ClusterKeys;
+  ClusterIdMapType            m_ClusterIds;
+  std::vector<ClusterSumType> m_ClusterSums;
+
+  bool m_DeferParsing{ false };
+  bool m_ParsingPending{ false };
+  bool m_ReadPointsOnly{ false };
+
+  bool                       m_TriangulatePolygons{ false };
+  std::vector<SizeValueType> m_CellOffsets;
+  std::vector<SizeValueType> m_FirstTriangles;
+
+  // Whether WriteCells() was called since WriteMeshInformation()
+  bool m_CellsWritten{ false };
+
+  bool          m_AppendToFile{ false };
+  bool          m_Appending{ false };
+  SizeValueType m_NumberOfExistingTriangles{ 0 };
+  SizeValueType m_NumberOfAppendedTriangles{ 0 };
+
+  unsigned int m_NumberOfShards{ 1 };
+  int          m_ShardAxis{ -1 };
+
+  bool   m_UseMemoryMappedWriter{ false };
+  int    m_OutputFileDescriptor{ -1 };
+  char * m_OutputMapping{ nullptr };
+  size_t m_OutputMappingSize{ 0 };
+
+  bool                              m_UseBackgroundWriter{ false };
+  std::unique_ptr<BackgroundWriter> m_BackgroundWriter;
 };
 } // end namespace itk
 
@@ -0,0 +1,114 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSTLQuadEdgeMeshReader_h
+#define itkSTLQuadEdgeMeshReader_h
+
+#include "itkObject.h"
+#include "itkSTLMeshIO.h"
+
+#include <string>
+
+namespace itk
+{
+/** \class STLQuadEdgeMeshReader
+ * \brief Read an STL file directly into a QuadEdgeMesh.
+ *
+ * The STLMeshIO computes the edge adjacency of the welded triangles while
+ * reading, see STLMeshIO::GetHalfEdgeNeighbors(). The points are then set
+ * in bulk, and the faces are added with AddFaceTriangle() in breadth-first
+ * order across the manifold edges, so that every face but the first one of
+ * each connected patch is attached to faces already in the mesh. This
+ * avoids the temporary non-manifold configurations, and the per-cell
+ * conversions, of adding the cells one at a time in file order.
+ *
+ * Faces that the QuadEdgeMesh cannot represent, such as the third face of
+ * a non-manifold edge or a face of opposite orientation to its neighbors,
+ * are rejected and counted.
+ *
+ * \ingroup IOFilters
+ * \ingroup IOMeshSTL
+ */
+template <typename TOutputMesh>
+class ITK_TEMPLATE_EXPORT STLQuadEdgeMeshReader : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(STLQuadEdgeMeshReader);
+
+  /** Standard class type aliases. */
+  using Self = STLQuadEdgeMeshReader;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(STLQuadEdgeMeshReader, Object);
+
+  using OutputMeshType = TOutputMesh;
+  using OutputMeshPointer = typename OutputMeshType::Pointer;
+
+  /** Set/Get the name of the file to read. */
+  itkSetStringMacro(FileName);
+  itkGetStringMacro(FileName);
+
+  /** Set/Get the STLMeshIO used to read the file, to control its reading
+   * options. A default one is used when none is set. The edge adjacency is
+   * computed whatever its ComputeEdgeAdjacency setting, which is restored
+   * after the read. The points are read in its point component type,
+   * FLOAT unless it was set to DOUBLE with SetPointComponentType(). */
+  itkSetObjectMacro(MeshIO, STLMeshIO);
+  itkGetModifiableObjectMacro(MeshIO, STLMeshIO);
+
+  /** Read the file. */
+  void
+  Update();
+
+  /** Get the mesh read from the file. */
+  OutputMeshType *
+  GetOutput() const
+  {
+    return this->m_Output.GetPointer();
+  }
+
+  /** Get the number of triangles of the file that could not be added to
+   * the mesh. */
+  itkGetConstMacro(NumberOfRejectedTriangles, SizeValueType);
+
+protected:
+  STLQuadEdgeMeshReader() = default;
+  ~STLQuadEdgeMeshReader() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  std::string        m_FileName;
+  STLMeshIO::Pointer m_MeshIO;
+
+  OutputMeshPointer m_Output;
+  SizeValueType     m_NumberOfRejectedTriangles{ 0 };
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkSTLQuadEdgeMeshReader.hxx"
+#endif
+
+#endif // itkSTLQuadEdgeMeshReader_h
@@ -0,0 +1,175 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkSTLQuadEdgeMeshReader_hxx
+#define itkSTLQuadEdgeMeshReader_hxx
+
+#include <vector>
+
+namespace itk
+{
+
+template <typename TOutputMesh>
+void
+STLQuadEdgeMeshReader<TOutputMesh>::Update()
+{
+  using PointType = typename OutputMeshType::PointType;
+  using PointsContainer = typename OutputMeshType::PointsContainer;
+  using PointIdentifier = typename OutputMeshType::PointIdentifier;
+  using CoordRepType = typename PointType::ValueType;
+
+  STLMeshIO::Pointer meshIO = this->m_MeshIO;
+  if (meshIO.IsNull())
+  {
+    meshIO = STLMeshIO::New();
+  }
+
+  if (!meshIO->CanReadFile(this->m_FileName.c_str()))
+  {
+    itkExceptionMacro("Unable to read file\n"
+                      "inputFilename= "
+                      << this->m_FileName);
+  }
+
+  //
+  // The edge adjacency is computed for this read only: the MeshIO of the
+  // caller gets its own setting back, also when the read fails.
+  //
+  struct EdgeAdjacencyRestorer
+  {
+    ~EdgeAdjacencyRestorer() { this->m_MeshIO->SetComputeEdgeAdjacency(this->m_ComputeEdgeAdjacency); }
+
+    STLMeshIO * m_MeshIO;
+    bool        m_ComputeEdgeAdjacency;
+  } edgeAdjacencyRestorer{ meshIO, meshIO->GetComputeEdgeAdjacency() };
+
+  meshIO->SetFileName(this->m_FileName);
+  meshIO->ComputeEdgeAdjacencyOn();
+  meshIO->ReadMeshInformation();
+
+  // The coordinates come in the point component type of the MeshIO, FLOAT
+  // unless the caller set DOUBLE. When the parsing is deferred, the number
+  // of points is only an upper bound until the points are read.
+  std::vector<float>  floatCoordinates;
+  std::vector<double> doubleCoordinates;
+  if (meshIO->GetPointComponentType() == MeshIOBase::IOComponentEnum::DOUBLE)
+  {
+    doubleCoordinates.resize(3 * meshIO->GetNumberOfPoints());
+    meshIO->ReadPoints(doubleCoordinates.data());
+  }
+  else
+  {
+    floatCoordinates.resize(3 * meshIO->GetNumberOfPoints());
+    meshIO->ReadPoints(floatCoordinates.data());
+  }
+
+  const SizeValueType numberOfPoints = meshIO->GetNumberOfPoints();
+  const SizeValueType numberOfTriangles = meshIO->GetNumberOfCells();
+
+  std::vector<IdentifierType> triangles(3 * numberOfTriangles);
+  meshIO->ReadTriangles(triangles.data(), MeshIOBase::MapComponentType<IdentifierType>::CType);
+
+  const STLMeshIO::HalfEdgeNeighborsType & neighbors = meshIO->GetHalfEdgeNeighbors();
+
+  //
+  // Set all the points at once
+  //
+  this->m_Output = OutputMeshType::New();
+
+  typename PointsContainer::Pointer points = PointsContainer::New();
+  points->Reserve(numberOfPoints);
+
+  const auto setPoints = [&points, numberOfPoints](const auto & coordinates) {
+    for (SizeValueType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+      PointType & point = points->ElementAt(pointId);
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        point[i] = static_cast<CoordRepType>(coordinates[3 * pointId + i]);
+      }
+    }
+  };
+
+  if (doubleCoordinates.empty())
+  {
+    setPoints(floatCoordinates);
+  }
+  else
+  {
+    setPoints(doubleCoordinates);
+  }
+  this->m_Output->SetPoints(points);
+
+  //
+  // Add the faces in breadth-first order across the manifold edges,
+  // starting a new patch from the first triangle not reached yet.
+  //
+  std::vector<bool>           reached(numberOfTriangles, false);
+  std::vector<IdentifierType> queue;
+  queue.reserve(numberOfTriangles);
+
+  this->m_NumberOfRejectedTriangles = 0;
+
+  for (SizeValueType seed = 0; seed < numberOfTriangles; ++seed)
+  {
+    if (reached[seed])
+    {
+      continue;
+    }
+
+    reached[seed] = true;
+    queue.push_back(seed);
+
+    for (SizeValueType next = queue.size() - 1; next < queue.size(); ++next)
+    {
+      const IdentifierType t = queue[next];
+
+      if (this->m_Output->AddFaceTriangle(static_cast<PointIdentifier>(triangles[3 * t]),
+                                          static_cast<PointIdentifier>(triangles[3 * t + 1]),
+                                          static_cast<PointIdentifier>(triangles[3 * t + 2])) == nullptr)
+      {
+        ++this->m_NumberOfRejectedTriangles;
+      }
+
+      for (unsigned int k = 0; k < 3; ++k)
+      {
+        const IdentifierType neighbor = neighbors[3 * t + k];
+        if (neighbor < STLMeshIO::NonManifoldHalfEdge && !reached[neighbor / 3])
+        {
+          reached[neighbor / 3] = true;
+          queue.push_back(neighbor / 3);
+        }
+      }
+    }
+  }
+}
+
+
+template <typename TOutputMesh>
+void
+STLQuadEdgeMeshReader<TOutputMesh>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "FileName: " << this->m_FileName << std::endl;
+  os << indent << "MeshIO: " << this->m_MeshIO.GetPointer() << std::endl;
+  os << indent << "NumberOfRejectedTriangles: " << this->m_NumberOfRejectedTriangles << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkSTLQuadEdgeMeshReader_hxx
@@ -14,9 +14,9 @@ itk_module(IOMeshSTL
   DEPENDS
     ITKCommon
     ITKIOMeshBase
+    ITKQuadEdgeMesh
   TEST_DEPENDS
     ITKTestKernel
-    ITKQuadEdgeMesh
   FACTORY_NAMES
     MeshIO::STL
   DESCRIPTION
@@ -19,657 +19,4798 @@
 #include "itkSTLMeshIO.h"
 #include "itkMetaDataObject.h"
 #include "itkByteSwapper.h"
+#include "itkMultiThreaderBase.h"
 
 #include <itksys/SystemTools.hxx>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#if __has_include(<charconv>)
+#  include <charconv>
+#endif
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
 #include <fstream>
 #include <iomanip>
+#include <limits>
+#include <locale>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#if !defined(_WIN32)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
 
 namespace itk
 {
-// Constructor
-STLMeshIO ::STLMeshIO()
+namespace
 {
-  this->AddSupportedWriteExtension(".stl");
-  this->AddSupportedWriteExtension(".STL");
+// Size of the chunks in which the serialized output is handed to the stream.
+constexpr size_t OutputChunkSize = 1 << 20;
+
+// Size of the header of a binary STL file: 80 bytes of free text followed
+// by the number of triangles.
+constexpr SizeValueType BinaryHeaderSize = 84;
+
+// Size of a triangle record in a binary STL file: normal, three vertices
+// and the attribute byte count.
+constexpr SizeValueType BinaryTriangleRecordSize = 50;
+
+// Number of triangle records read from a binary file at once.
+constexpr SizeValueType BinaryTrianglesPerBlock = 1 << 14;
+
+// Formatter of the facets of the ASCII files written by this class. The
+// coordinates are formatted as by printf("%g") in the classic "C" locale,
+// whatever the locale of the process, since STL readers expect a period as
+// decimal separator. The text of a facet is stored in a fixed array, so
+// that formatting does not allocate.
+class AsciiFacetFormatter : private std::streambuf
+{
+public:
+  AsciiFacetFormatter()
+  {
+#if !defined(__cpp_lib_to_chars)
+    this->m_Stream.imbue(std::locale::classic());
+#endif
+  }
 
-  // STL uses float type by default to store point data
-  this->SetPointComponentType(IOComponentEnum::FLOAT);
+  // Format the facet of the given normal and vertices, and return the
+  // length of its text.
+  size_t
+  Format(const float * normal, const float * vertex0, const float * vertex1, const float * vertex2)
+  {
+    this->setp(this->m_Text, this->m_Text + sizeof(this->m_Text));
 
-  // STL uses UINT32 to store the number of points,
-  // hence the point Ids are of the same UINT32 type.
-  this->SetCellComponentType(IOComponentEnum::UINT);
+    this->AppendText("  facet normal ");
+    this->AppendTriplet(normal);
+    this->AppendText("    outer loop\n");
+    for (const float * vertex : { vertex0, vertex1, vertex2 })
+    {
+      this->AppendText("      vertex ");
+      this->AppendTriplet(vertex);
+    }
+    this->AppendText("    endloop\n"
+                     "  endfacet\n");
 
-  this->SetPointDimension(3);
-}
+    return static_cast<size_t>(this->pptr() - this->pbase());
+  }
 
-bool
-STLMeshIO ::CanReadFile(const char * fileName)
-{
-  if (!itksys::SystemTools::FileExists(fileName, true))
+  const char *
+  GetText() const
   {
-    return false;
+    return this->m_Text;
   }
 
-  const std::string extension = itksys::SystemTools::GetFilenameLastExtension(fileName);
+private:
+  template <size_t VLength>
+  void
+  AppendText(const char (&text)[VLength])
+  {
+    this->sputn(text, VLength - 1);
+  }
 
-  if (extension != ".stl" && extension != ".STL")
+  void
+  AppendTriplet(const float * values)
   {
-    return false;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      if (i > 0)
+      {
+        this->sputc(' ');
+      }
+#if defined(__cpp_lib_to_chars)
+      const std::to_chars_result result =
+        std::to_chars(this->pptr(), this->epptr(), values[i], std::chars_format::general, 6);
+      this->pbump(static_cast<int>(result.ptr - this->pptr()));
+#else
+      this->m_Stream << values[i];
+#endif
+    }
+    this->sputc('\n');
   }
 
-  return true;
-}
+  // Large enough for twelve floats of at most 13 characters each.
+  char m_Text[512];
+#if !defined(__cpp_lib_to_chars)
+  std::ostream m_Stream{ this };
+#endif
+};
 
-bool
-STLMeshIO ::CanWriteFile(const char * fileName)
+#if !defined(__cpp_lib_to_chars)
+// Parser of numbers in the classic "C" locale, through a stream that reads
+// the text in place.
+class AsciiFloatParser : private std::streambuf
 {
-  const std::string extension = itksys::SystemTools::GetFilenameLastExtension(fileName);
+public:
+  AsciiFloatParser() { this->m_Stream.imbue(std::locale::classic()); }
 
-  if (extension != ".stl" && extension != ".STL")
+  const char *
+  Parse(const char * text, const char * end, double & value)
   {
-    return false;
+    this->setg(const_cast<char *>(text), const_cast<char *>(text), const_cast<char *>(end));
+    this->m_Stream.clear();
+    this->m_Stream >> value;
+    return this->m_Stream.fail() ? nullptr : this->gptr();
   }
 
-  return true;
+private:
+  std::istream m_Stream{ this };
+};
+#endif
+
+// Parse the number that follows the blanks at text, as strtof() does but in
+// the classic "C" locale whatever the locale of the process, since STL files
+// use a period as decimal separator. Return the end of the number, or
+// nullptr when the text does not start with a number.
+const char *
+ParseAsciiFloat(const char * text, const char * end, float & value)
+{
+  while (text != end && (*text == ' ' || *text == '\t' || *text == '\r'))
+  {
+    ++text;
+  }
+
+#if defined(__cpp_lib_to_chars)
+  // Unlike strtof(), std::from_chars() does not skip a plus sign.
+  const char * first = text != end && *text == '+' ? text + 1 : text;
+
+  std::from_chars_result result = std::from_chars(first, end, value);
+  if (result.ec != std::errc::result_out_of_range)
+  {
+    return result.ec == std::errc() ? result.ptr : nullptr;
+  }
+
+  double wideValue = 0.0;
+  result = std::from_chars(first, end, wideValue);
+  const char * numberEnd = result.ec == std::errc() ? result.ptr : nullptr;
+#else
+  // The stream fails on floats out of range, so the number is read as a
+  // double and then rounded.
+  static thread_local AsciiFloatParser parser;
+  double                               wideValue = 0.0;
+  const char *                         numberEnd = parser.Parse(text, end, wideValue);
+#endif
+
+  // Magnitudes out of the range of floats saturate, as with strtof().
+  if (std::abs(wideValue) > std::numeric_limits<float>::max())
+  {
+    wideValue = std::copysign(std::numeric_limits<double>::infinity(), wideValue);
+  }
+  value = static_cast<float>(wideValue);
+  return numberEnd;
 }
 
+// Text of the 80-byte header of the binary files written by this class.
 void
-STLMeshIO ::Read()
-{}
+FormatBinaryHeader(char header[80])
+{
+  char text[81];
+  std::snprintf(text, sizeof(text), "%80s", "binary STL generated from ITK");
+  std::memcpy(header, text, 80);
+}
 
-void
-STLMeshIO ::ReadMeshInformation()
+// Area of a triangle, computed in double precision since the vertices are
+// only stored as floats.
+double
+TriangleArea(const STLMeshIO::PointType & p0, const STLMeshIO::PointType & p1, const STLMeshIO::PointType & p2)
 {
+  const double ab[3] = { double{ p1[0] } - p0[0], double{ p1[1] } - p0[1], double{ p1[2] } - p0[2] };
+  const double ac[3] = { double{ p2[0] } - p0[0], double{ p2[1] } - p0[1], double{ p2[2] } - p0[2] };
 
-  // Use default filetype
-  if (this->GetFileType() == IOFileEnum::ASCII)
+  const double cross[3] = { ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0] };
+
+  return 0.5 * std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+}
+
+// Integer coordinate of a cluster cell, from the coordinate of a vertex in
+// units of the cell size, clamped to the range of int64_t.
+int64_t
+ClusterCoordinate(double coordinate)
+{
+  constexpr double limit = 9.2e18;
+  return static_cast<int64_t>(std::max(-limit, std::min(std::floor(coordinate), limit)));
+}
+
+// Signature of the spatial index files, including a format version.
+constexpr char SpatialIndexMagic[8] = { 'S', 'T', 'L', 'I', 'D', 'X', '0', '1' };
+
+// Signature of the welded mesh cache files, including a format version.
+constexpr char WeldedMeshCacheMagic[8] = { 'S', 'T', 'L', 'W', 'L', 'D', '0', '1' };
+
+// Vertex of a triangle, as sorted by the external memory weld. The
+// occurrence is 3 * triangle index + index of the vertex in the triangle.
+struct WeldVertexType
+{
+  float    m_Coordinates[3];
+  uint32_t m_Padding;
+  uint64_t m_Occurrence;
+};
+
+// Lexicographic order of the coordinates, then order of occurrence.
+bool
+WeldVertexLess(const WeldVertexType & a, const WeldVertexType & b)
+{
+  for (unsigned int i = 0; i < 3; ++i)
   {
-    this->m_InputStream.open(this->m_FileName.c_str(), std::ios::in);
+    if (a.m_Coordinates[i] != b.m_Coordinates[i])
+    {
+      return a.m_Coordinates[i] < b.m_Coordinates[i];
+    }
   }
-  else if (this->GetFileType() == IOFileEnum::BINARY)
+  return a.m_Occurrence < b.m_Occurrence;
+}
+
+// Point Id of a vertex occurrence, as distributed to the buckets.
+struct WeldPointIdType
+{
+  uint64_t m_Occurrence;
+  uint64_t m_PointId;
+};
+
+// Buffered reader of a sorted run of vertices.
+class WeldRunReader
+{
+public:
+  WeldRunReader(const std::string & fileName, SizeValueType bufferSize)
+    : m_Stream(fileName.c_str(), std::ios::in | std::ios::binary)
+    , m_Buffer(bufferSize)
   {
-    this->m_InputStream.open(this->m_FileName.c_str(), std::ios::in | std::ios::binary);
+    this->Fill();
   }
 
-  if (!this->m_InputStream.is_open())
+  bool
+  IsOpen() const
   {
-    itkExceptionMacro("Unable to open file\n"
-                      "inputFilename= "
-                      << this->m_FileName);
-    return;
+    return this->m_Stream.is_open();
   }
 
+  bool
+  IsValid() const
+  {
+    return this->m_Position < this->m_Count;
+  }
 
-  // Read STL header file(the first line)
-  char headerBuffer[6];
-  this->m_InputStream.read(headerBuffer, 6);
-  this->m_InputStream.seekg(0); // Reset to the beginning of the file.
-
-  headerBuffer[5] = '\0';
-  std::string header(headerBuffer);
+  const WeldVertexType &
+  Current() const
+  {
+    return this->m_Buffer[this->m_Position];
+  }
 
-  bool inputFileIsASCII = false;
+  void
+  Advance()
+  {
+    if (++this->m_Position == this->m_Count)
+    {
+      this->Fill();
+    }
+  }
 
-  // Based on the header line define whether the file is ASCII or BINARY
-  if (header.find("solid") != std::string::npos)
+private:
+  void
+  Fill()
   {
-    inputFileIsASCII = true;
+    this->m_Stream.read(reinterpret_cast<char *>(this->m_Buffer.data()),
+                        this->m_Buffer.size() * sizeof(WeldVertexType));
+    this->m_Count = this->m_Stream.gcount() / sizeof(WeldVertexType);
+    this->m_Position = 0;
   }
 
-  // Determine file type
-  if (inputFileIsASCII)
+  std::ifstream               m_Stream;
+  std::vector<WeldVertexType> m_Buffer;
+  SizeValueType               m_Position{ 0 };
+  SizeValueType               m_Count{ 0 };
+};
+
+// Number of runs merged, or of bucket files written, at once by the
+// external memory weld, well below the usual limits on open files.
+constexpr SizeValueType MaximumNumberOfOpenWeldFiles = 64;
+
+// Writer of the point Ids of the occurrences to the files of consecutive
+// groups of buckets, each group holding occurrencesPerGroup occurrences
+// from firstOccurrence on.
+class WeldBucketWriter
+{
+public:
+  WeldBucketWriter(const std::vector<std::string> & fileNames,
+                   uint64_t                         firstOccurrence,
+                   uint64_t                         occurrencesPerGroup)
+    : m_FileNames(fileNames)
+    , m_Streams(fileNames.size())
+    , m_FirstOccurrence(firstOccurrence)
+    , m_OccurrencesPerGroup(occurrencesPerGroup)
   {
-    if (this->GetFileType() != IOFileEnum::ASCII)
+    for (SizeValueType g = 0; g < fileNames.size(); ++g)
     {
-      this->SetFileType(IOFileEnum::ASCII);
-#ifdef _WIN32
-      this->m_InputStream.close();
-      this->m_InputStream.open(this->m_FileName.c_str(), std::ios::in);
-      if (!this->m_InputStream.is_open())
-      {
-        itkExceptionMacro("Unable to open file\n"
-                          "inputFilename= "
-                          << this->m_FileName);
-        return;
-      }
-#endif
+      this->m_Streams[g].open(fileNames[g].c_str(), std::ios::out | std::ios::binary);
     }
+  }
 
-    this->ReadMeshInternalFromAscii();
+  void
+  Write(const WeldPointIdType & entry)
+  {
+    this->m_Streams[(entry.m_Occurrence - this->m_FirstOccurrence) / this->m_OccurrencesPerGroup].write(
+      reinterpret_cast<const char *>(&entry), sizeof(entry));
   }
-  else
+
+  // Returns the name of the first file that could not be written, or an
+  // empty string.
+  std::string
+  Close()
   {
-    if (this->GetFileType() != IOFileEnum::BINARY)
+    std::string failedFileName;
+    for (SizeValueType g = 0; g < this->m_Streams.size(); ++g)
     {
-      this->SetFileType(IOFileEnum::BINARY);
-#ifdef _WIN32
-      this->m_InputStream.close();
-      this->m_InputStream.open(this->m_FileName.c_str(), std::ios::in | std::ios::binary);
-      if (!this->m_InputStream.is_open())
+      this->m_Streams[g].close();
+      if (!this->m_Streams[g] && failedFileName.empty())
       {
-        itkExceptionMacro("Unable to open file\n"
-                          "inputFilename= "
-                          << this->m_FileName);
-        return;
+        failedFileName = this->m_FileNames[g];
       }
-#endif
     }
+    return failedFileName;
+  }
 
-    this->ReadMeshInternalFromBinary();
+private:
+  std::vector<std::string>   m_FileNames;
+  std::vector<std::ofstream> m_Streams;
+  uint64_t                   m_FirstOccurrence;
+  uint64_t                   m_OccurrencesPerGroup;
+};
+
+// Cells to write in the WriteCells() layout: cell type, number of points
+// and point Ids. Without triangulation, every cell is a triangle that
+// takes five entries of the buffer; otherwise, the offset of every cell
+// and the index of its first triangle come from IndexCellsForWriting().
+class CellBufferView
+{
+public:
+  CellBufferView(const IdentifierType *             buffer,
+                 const std::vector<SizeValueType> & cellOffsets,
+                 const std::vector<SizeValueType> & firstTriangles)
+    : m_Buffer(buffer)
+    , m_CellOffsets(cellOffsets.empty() ? nullptr : cellOffsets.data())
+    , m_FirstTriangles(firstTriangles.empty() ? nullptr : firstTriangles.data())
+  {}
+
+  SizeValueType
+  GetNumberOfPoints(SizeValueType cellId) const
+  {
+    return static_cast<SizeValueType>(this->m_Buffer[this->GetOffset(cellId) + 1]);
   }
 
-  this->m_InputStream.close();
-}
+  const IdentifierType *
+  GetPointIds(SizeValueType cellId) const
+  {
+    return this->m_Buffer + this->GetOffset(cellId) + 2;
+  }
 
+  SizeValueType
+  GetFirstTriangle(SizeValueType cellId) const
+  {
+    return this->m_FirstTriangles != nullptr ? this->m_FirstTriangles[cellId] : cellId;
+  }
 
-void
-STLMeshIO ::ReadMeshInternalFromAscii()
+private:
+  SizeValueType
+  GetOffset(SizeValueType cellId) const
+  {
+    return this->m_CellOffsets != nullptr ? this->m_CellOffsets[cellId] : 5 * cellId;
+  }
+
+  const IdentifierType * m_Buffer;
+  const SizeValueType *  m_CellOffsets;
+  const SizeValueType *  m_FirstTriangles;
+};
+
+// Triangles to write as packed triplets of point Ids, read where the
+// caller stored them.
+template <typename TPointId>
+class PackedTriangleView
 {
-  // Read all the points, and reduce them to unique ones
-  PointType p0;
-  PointType p1;
-  PointType p2;
+public:
+  explicit PackedTriangleView(const TPointId * buffer)
+    : m_Buffer(buffer)
+  {}
 
-  this->m_InputLineNumber = 2;
+  static SizeValueType
+  GetNumberOfPoints(SizeValueType)
+  {
+    return 3;
+  }
+
+  const TPointId *
+  GetPointIds(SizeValueType cellId) const
+  {
+    return this->m_Buffer + 3 * cellId;
+  }
 
-  this->m_LatestPointId = NumericTraits<IdentifierType>::Zero;
+  static SizeValueType
+  GetFirstTriangle(SizeValueType cellId)
+  {
+    return cellId;
+  }
 
-  // read header line
-  std::getline(this->m_InputStream, this->m_InputLine, '\n');
+private:
+  const TPointId * m_Buffer;
+};
+} // namespace
+
+//
+// Single-producer / single-consumer ring of output chunks.
+//
+// The cell loop (producer) swaps a filled chunk into a free slot and gets
+// back the buffer that the writer thread (consumer) already flushed, so that
+// no allocation takes place once the ring has been filled once. Each side
+// sleeps on a condition variable while the ring is full or empty, so that
+// neither one burns a core while the other formats or waits on the disk.
+//
+class STLMeshIO::BackgroundWriter
+{
+public:
+  explicit BackgroundWriter(std::ostream & stream)
+    : m_Stream(stream)
+    , m_Thread(&BackgroundWriter::Run, this)
+  {}
 
-  while (!this->CheckStringFromAscii("endsolid"))
+  ~BackgroundWriter()
   {
-    //
-    // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
-    //
-    //  facet normal ni nj nk
-    //      outer loop
-    //          vertex v1x v1y v1z
-    //          vertex v2x v2y v2z
-    //          vertex v3x v3y v3z
-    //      endloop
-    //  endfacet
-    //
-    this->m_PointInTriangleCounter = 0;
+    if (m_Thread.joinable())
+    {
+      this->Finish();
+    }
+  }
 
-    this->ReadStringFromAscii("facet normal");
-    this->ReadStringFromAscii("outer loop");
-    this->ReadPointAsAscii(p0);
-    this->ReadPointAsAscii(p1);
-    this->ReadPointAsAscii(p2);
-    this->ReadStringFromAscii("endloop");
-    this->ReadStringFromAscii("endfacet");
+  /** Hand a filled chunk to the writer thread, and receive an empty one. */
+  void
+  Push(std::vector<char> & chunk)
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_SlotFreed.wait(lock, [this] { return m_Head - m_Tail < NumberOfSlots; });
+    const size_t head = m_Head;
+    lock.unlock();
+
+    // The writer thread only reads the slots in [tail, head).
+    m_Slots[head % NumberOfSlots].swap(chunk);
+    chunk.clear();
+    chunk.reserve(OutputChunkSize);
+
+    lock.lock();
+    m_Head = head + 1;
+    lock.unlock();
+    m_SlotFilled.notify_one();
+  }
 
-    this->m_CellsVector.push_back(this->m_TrianglePointIds);
+  /** Wait until all the chunks have been written, return false on I/O error. */
+  bool
+  Finish()
+  {
+    {
+      const std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Done = true;
+    }
+    m_SlotFilled.notify_one();
+    m_Thread.join();
+    return !m_Failed;
   }
 
-  this->SetNumberOfPoints(this->m_PointsMap.size());
-  this->SetNumberOfCells(this->m_CellsVector.size());
+private:
+  void
+  Run()
+  {
+    size_t tail = 0;
+    for (;;)
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_SlotFilled.wait(lock, [this, tail] { return tail != m_Head || m_Done; });
+      if (tail == m_Head)
+      {
+        break;
+      }
+      lock.unlock();
 
-  //
-  // The factor 5 accounts for five integers
-  //  1. cell type id
-  //  2. number of points in cell
-  //  3. point id of point 0
-  //  4. point id of point 1
-  //  5. point id of point 2
-  //
-  this->SetCellBufferSize(5 * this->m_CellsVector.size());
-}
+      const std::vector<char> & slot = m_Slots[tail % NumberOfSlots];
+
+      // After a failure the remaining chunks are drained without writing.
+      if (!m_Failed)
+      {
+        m_Stream.write(slot.data(), slot.size());
+        m_Failed = m_Stream.fail();
+      }
 
+      lock.lock();
+      m_Tail = ++tail;
+      lock.unlock();
+      m_SlotFreed.notify_one();
+    }
 
-void
-STLMeshIO ::ReadStringFromAscii(const std::string & expected)
+    if (!m_Failed)
+    {
+      m_Stream.flush();
+      m_Failed = m_Stream.fail();
+    }
+  }
+
+  static constexpr size_t NumberOfSlots = 4;
+
+  std::ostream &    m_Stream;
+  std::vector<char> m_Slots[NumberOfSlots];
+
+  // Number of chunks pushed and written, and end of the output, guarded by m_Mutex.
+  std::mutex              m_Mutex;
+  std::condition_variable m_SlotFilled;
+  std::condition_variable m_SlotFreed;
+  size_t                  m_Head{ 0 };
+  size_t                  m_Tail{ 0 };
+  bool                    m_Done{ false };
+  bool                    m_Failed{ false };
+
+  // Declared last, so that the thread starts once the ring is constructed.
+  std::thread m_Thread;
+};
+
+//
+// Read-only stream buffer over memory owned by the caller.
+//
+// Consume() hands out the address of the next bytes and skips them, so
+// that the binary records are decoded where they are.
+//
+class STLMeshIO::MemoryReadBuffer : public std::streambuf
 {
-  if (this->m_InputLine.empty())
+public:
+  MemoryReadBuffer(const char * data, SizeValueType size)
   {
-    std::getline(this->m_InputStream, this->m_InputLine, '\n');
+    char * begin = const_cast<char *>(data);
+    this->setg(begin, begin, begin + size);
   }
 
-  if (this->m_InputLine.find(expected) == std::string::npos)
+  /** Skip the next bytes and return their address, or nullptr past the end. */
+  const char *
+  Consume(SizeValueType size)
   {
-    itkExceptionMacro("Parsing error: missed " << expected << " in line " << this->m_InputLineNumber
-                                               << " found: " << this->m_InputLine);
+    if (static_cast<SizeValueType>(this->egptr() - this->gptr()) < size)
+    {
+      this->setg(this->eback(), this->egptr(), this->egptr());
+      return nullptr;
+    }
+
+    const char * data = this->gptr();
+    this->setg(this->eback(), this->gptr() + size, this->egptr());
+    return data;
   }
 
-  this->m_InputLine.clear();
+protected:
+  pos_type
+  seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode) override
+  {
+    if (direction == std::ios_base::cur)
+    {
+      offset += this->gptr() - this->eback();
+    }
+    else if (direction == std::ios_base::end)
+    {
+      offset += this->egptr() - this->eback();
+    }
 
-  this->m_InputLineNumber++;
-}
+    if (offset < 0 || offset > this->egptr() - this->eback())
+    {
+      return pos_type(off_type(-1));
+    }
 
+    this->setg(this->eback(), this->eback() + offset, this->egptr());
+    return pos_type(offset);
+  }
 
-bool
-STLMeshIO ::CheckStringFromAscii(const std::string & expected)
+  pos_type
+  seekpos(pos_type position, std::ios_base::openmode which) override
+  {
+    return this->seekoff(off_type(position), std::ios_base::beg, which);
+  }
+};
+
+#if defined(__linux__)
+//
+// Read-ahead buffer over a file opened with O_DIRECT.
+//
+// The file is split into aligned blocks. Slot k of the ring holds the blocks
+// k, k + NumberOfSlots, k + 2 * NumberOfSlots, ... and is filled with pread()
+// by the read-ahead threads, which are shared by all the buffers of the
+// process, so that requests are queued on the device while the decoders
+// consume the current block, without starting threads for every file. Once
+// a block is consumed, its slot is handed the block NumberOfSlots positions
+// ahead. A seek outside of the current block retargets the slots, each one
+// once its pending read has completed.
+//
+class STLMeshIO::DirectReadBuffer : public std::streambuf
 {
-  std::getline(this->m_InputStream, this->m_InputLine, '\n');
+public:
+  DirectReadBuffer() = default;
 
-  if (this->m_InputLine.find(expected) != std::string::npos)
+  ~DirectReadBuffer() override
   {
-    this->m_InputLineNumber++;
-    return true;
-  }
+    if (m_FileDescriptor >= 0)
+    {
+      ReadAheadPool::GetInstance().Cancel(this);
+    }
 
-  return false;
-}
+    // The reads already started complete before their slot is freed.
+    for (Slot & slot : m_Slots)
+    {
+      {
+        std::unique_lock<std::mutex> lock(slot.m_Mutex);
+        slot.m_Condition.wait(lock, [&slot] { return slot.m_State != SlotState::Loading; });
+      }
+      std::free(slot.m_Data);
+    }
+
+    if (m_FileDescriptor >= 0)
+    {
+      ::close(m_FileDescriptor);
+    }
+  }
+
+  /** Open the file and start reading its first blocks, return false on failure. */
+  bool
+  Open(const std::string & fileName)
+  {
+    m_FileDescriptor = ::open(fileName.c_str(), O_RDONLY | O_DIRECT);
+    if (m_FileDescriptor < 0 && errno == EINVAL)
+    {
+      // The file system does not support direct I/O: read through the page
+      // cache, and drop the pages of the blocks once they are consumed.
+      m_FileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+      m_Direct = false;
+    }
+
+    struct stat status;
+    if (m_FileDescriptor < 0 || ::fstat(m_FileDescriptor, &status) != 0)
+    {
+      return false;
+    }
+    m_FileSize = static_cast<uint64_t>(status.st_size);
+
+    if (!m_Direct)
+    {
+      ::posix_fadvise(m_FileDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    for (unsigned int k = 0; k < NumberOfSlots; ++k)
+    {
+      Slot & slot = m_Slots[k];
+      if (::posix_memalign(reinterpret_cast<void **>(&slot.m_Data), Alignment, BlockSize) != 0)
+      {
+        slot.m_Data = nullptr;
+        return false;
+      }
+      slot.m_Block = k;
+      if (uint64_t{ k } * BlockSize < m_FileSize)
+      {
+        slot.m_State = SlotState::Pending;
+        ReadAheadPool::GetInstance().Submit(this, &slot);
+      }
+    }
+
+    return true;
+  }
+
+protected:
+  int_type
+  underflow() override
+  {
+    if (this->gptr() < this->egptr())
+    {
+      return traits_type::to_int_type(*this->gptr());
+    }
+
+    if (m_HasBlock)
+    {
+      m_NextBlock = m_CurrentBlock + 1;
+      m_NextOffset = 0;
+      this->Release();
+    }
+
+    if (!this->Load(m_NextBlock, m_NextOffset))
+    {
+      return traits_type::eof();
+    }
+
+    return traits_type::to_int_type(*this->gptr());
+  }
+
+  pos_type
+  seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which) override
+  {
+    if (direction == std::ios_base::cur)
+    {
+      offset += this->Tell();
+    }
+    else if (direction == std::ios_base::end)
+    {
+      offset += static_cast<off_type>(m_FileSize);
+    }
+
+    return this->seekpos(pos_type(offset), which);
+  }
+
+  pos_type
+  seekpos(pos_type position, std::ios_base::openmode) override
+  {
+    const off_type offset = position;
+    if (offset < 0 || static_cast<uint64_t>(offset) > m_FileSize)
+    {
+      return pos_type(off_type(-1));
+    }
+
+    const uint64_t block = static_cast<uint64_t>(offset) / BlockSize;
+    const size_t   offsetInBlock = static_cast<size_t>(static_cast<uint64_t>(offset) % BlockSize);
+
+    if (m_HasBlock && block == m_CurrentBlock)
+    {
+      this->setg(this->eback(), this->eback() + offsetInBlock, this->egptr());
+      return position;
+    }
+
+    // The block is loaded by the next read.
+    if (m_HasBlock)
+    {
+      this->Release();
+    }
+    m_NextBlock = block;
+    m_NextOffset = offsetInBlock;
+
+    return position;
+  }
+
+private:
+  enum class SlotState
+  {
+    Idle,
+    Pending,
+    Loading,
+    Ready
+  };
+
+  struct Slot
+  {
+    std::mutex              m_Mutex;
+    std::condition_variable m_Condition;
+    char *                  m_Data{ nullptr };
+    uint64_t                m_Block{ 0 };
+    ssize_t                 m_Size{ 0 };
+    SlotState               m_State{ SlotState::Idle };
+  };
+
+  off_type
+  Tell() const
+  {
+    if (m_HasBlock)
+    {
+      return static_cast<off_type>(m_CurrentBlock * BlockSize) + (this->gptr() - this->eback());
+    }
+    return static_cast<off_type>(m_NextBlock * BlockSize + m_NextOffset);
+  }
+
+  /** Wait for a block and make it the current one. */
+  bool
+  Load(uint64_t block, size_t offsetInBlock)
+  {
+    if (block * BlockSize >= m_FileSize)
+    {
+      return false;
+    }
+
+    for (unsigned int k = 0; k < NumberOfSlots; ++k)
+    {
+      this->Request(block + k);
+    }
+
+    Slot &                       slot = m_Slots[block % NumberOfSlots];
+    std::unique_lock<std::mutex> lock(slot.m_Mutex);
+    slot.m_Condition.wait(lock, [&slot] { return slot.m_State == SlotState::Ready; });
+
+    if (slot.m_Size < 0 || offsetInBlock >= static_cast<size_t>(slot.m_Size))
+    {
+      return false;
+    }
+
+    this->setg(slot.m_Data, slot.m_Data + offsetInBlock, slot.m_Data + slot.m_Size);
+    m_CurrentBlock = block;
+    m_HasBlock = true;
+    return true;
+  }
+
+  /** Hand the slot of the current block over to the block NumberOfSlots positions ahead. */
+  void
+  Release()
+  {
+    this->setg(nullptr, nullptr, nullptr);
+    m_HasBlock = false;
+
+    if (!m_Direct)
+    {
+      ::posix_fadvise(m_FileDescriptor,
+                      static_cast<off_t>(m_CurrentBlock * BlockSize),
+                      static_cast<off_t>(BlockSize),
+                      POSIX_FADV_DONTNEED);
+    }
+
+    this->Request(m_CurrentBlock + NumberOfSlots);
+  }
+
+  /** Make the slot of a block read it, unless it already holds it. */
+  void
+  Request(uint64_t block)
+  {
+    if (block * BlockSize >= m_FileSize)
+    {
+      return;
+    }
+
+    Slot & slot = m_Slots[block % NumberOfSlots];
+    {
+      std::unique_lock<std::mutex> lock(slot.m_Mutex);
+      if (slot.m_Block == block && slot.m_State != SlotState::Idle)
+      {
+        return;
+      }
+      slot.m_Condition.wait(lock, [&slot] { return slot.m_State != SlotState::Loading; });
+      slot.m_Block = block;
+      slot.m_State = SlotState::Pending;
+    }
+    ReadAheadPool::GetInstance().Submit(this, &slot);
+  }
+
+  //
+  // Threads of the process that read the pending slots of all the buffers,
+  // in the order they were requested. A request only names a slot: the
+  // block is taken when the read starts, and a request for a slot that is
+  // no longer pending is skipped.
+  //
+  class ReadAheadPool
+  {
+  public:
+    static ReadAheadPool &
+    GetInstance()
+    {
+      static ReadAheadPool pool;
+      return pool;
+    }
+
+    void
+    Submit(DirectReadBuffer * buffer, Slot * slot)
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Requests.push_back(Request{ buffer, slot });
+      }
+      m_Condition.notify_one();
+    }
+
+    /** Drop the requests of a buffer that were not started yet. */
+    void
+    Cancel(const DirectReadBuffer * buffer)
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Requests.erase(std::remove_if(m_Requests.begin(),
+                                      m_Requests.end(),
+                                      [buffer](const Request & request) { return request.m_Buffer == buffer; }),
+                       m_Requests.end());
+    }
+
+  private:
+    struct Request
+    {
+      DirectReadBuffer * m_Buffer;
+      Slot *             m_Slot;
+    };
+
+    ReadAheadPool()
+    {
+      for (std::thread & thread : m_Threads)
+      {
+        thread = std::thread(&ReadAheadPool::Run, this);
+      }
+    }
+
+    ~ReadAheadPool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopped = true;
+      }
+      m_Condition.notify_all();
+
+      for (std::thread & thread : m_Threads)
+      {
+        thread.join();
+      }
+    }
+
+    void
+    Run()
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      for (;;)
+      {
+        m_Condition.wait(lock, [this] { return m_Stopped || !m_Requests.empty(); });
+        if (m_Requests.empty())
+        {
+          break;
+        }
+
+        const Request request = m_Requests.front();
+        m_Requests.pop_front();
+
+        // The slot is marked as loading before the queue is unlocked, so
+        // that a buffer being destroyed either cancels the request or
+        // waits for the read.
+        Slot &   slot = *request.m_Slot;
+        uint64_t block = 0;
+        {
+          std::lock_guard<std::mutex> slotLock(slot.m_Mutex);
+          if (slot.m_State != SlotState::Pending)
+          {
+            continue;
+          }
+          block = slot.m_Block;
+          slot.m_State = SlotState::Loading;
+        }
+        lock.unlock();
+
+        const ssize_t size = request.m_Buffer->ReadBlock(slot.m_Data, block);
+
+        {
+          std::lock_guard<std::mutex> slotLock(slot.m_Mutex);
+          slot.m_Size = size;
+          slot.m_State = SlotState::Ready;
+          slot.m_Condition.notify_all();
+        }
+        lock.lock();
+      }
+    }
+
+    static constexpr unsigned int NumberOfThreads = 4;
+
+    std::mutex              m_Mutex;
+    std::condition_variable m_Condition;
+    std::deque<Request>     m_Requests;
+    bool                    m_Stopped{ false };
+    std::thread             m_Threads[NumberOfThreads];
+  };
+
+  /** Read a block, or the part of the last one before the end of the file. */
+  ssize_t
+  ReadBlock(char * data, uint64_t block)
+  {
+    const off_t offset = static_cast<off_t>(block * BlockSize);
+    size_t      size = 0;
+    bool        retried = false;
+    while (size < BlockSize)
+    {
+      const ssize_t count = ::pread(m_FileDescriptor, data + size, BlockSize - size, offset + size);
+      if (count > 0)
+      {
+        size += static_cast<size_t>(count);
+      }
+      else if (count == 0)
+      {
+        break;
+      }
+      else if (errno == EINVAL && !retried)
+      {
+        // The device refused the alignment of the request, after a short
+        // read for instance: read through the page cache from now on.
+        retried = true;
+        m_Direct = false;
+        ::fcntl(m_FileDescriptor, F_SETFL, ::fcntl(m_FileDescriptor, F_GETFL) & ~O_DIRECT);
+      }
+      else if (errno != EINTR)
+      {
+        return -1;
+      }
+    }
+    return static_cast<ssize_t>(size);
+  }
+
+  static constexpr size_t       BlockSize = 1 << 20;
+  static constexpr size_t       Alignment = 4096;
+  static constexpr unsigned int NumberOfSlots = 4;
+
+  int               m_FileDescriptor{ -1 };
+  uint64_t          m_FileSize{ 0 };
+  std::atomic<bool> m_Direct{ true };
+
+  bool     m_HasBlock{ false };
+  uint64_t m_CurrentBlock{ 0 };
+  uint64_t m_NextBlock{ 0 };
+  size_t   m_NextOffset{ 0 };
+
+  Slot m_Slots[NumberOfSlots];
+};
+#endif
+
+// Constructor
+STLMeshIO ::STLMeshIO()
+{
+  this->AddSupportedWriteExtension(".stl");
+  this->AddSupportedWriteExtension(".STL");
+
+  // STL uses float type by default to store point data
+  this->SetPointComponentType(IOComponentEnum::FLOAT);
+
+  // STL uses UINT32 to store the number of points,
+  // hence the point Ids are of the same UINT32 type.
+  this->SetCellComponentType(IOComponentEnum::UINT);
+
+  this->SetPointDimension(3);
+}
+
+// Destructor
+STLMeshIO ::~STLMeshIO()
+{
+  this->RemoveExternalWeldFiles();
+  this->ReleaseMemoryMappedOutput();
+}
+
+bool
+STLMeshIO ::CanReadFile(const char * fileName)
+{
+  if (!itksys::SystemTools::FileExists(fileName, true))
+  {
+    return false;
+  }
+
+  const std::string extension = itksys::SystemTools::GetFilenameLastExtension(fileName);
+
+  if (extension != ".stl" && extension != ".STL")
+  {
+    return false;
+  }
+
+  return true;
+}
+
+bool
+STLMeshIO ::CanWriteFile(const char * fileName)
+{
+  const std::string extension = itksys::SystemTools::GetFilenameLastExtension(fileName);
+
+  if (extension != ".stl" && extension != ".STL")
+  {
+    return false;
+  }
+
+  return true;
+}
+
+void
+STLMeshIO ::Read()
+{}
+
+void
+STLMeshIO ::ReadMeshInformation()
+{
+  this->m_ParsingPending = false;
+
+  // Points are read as floats, as stored in the file, unless the caller
+  // asked for doubles.
+  if (this->GetPointComponentType() != IOComponentEnum::DOUBLE)
+  {
+    this->SetPointComponentType(IOComponentEnum::FLOAT);
+  }
+
+  this->m_CachedPoints.clear();
+  this->m_CachedTriangles.clear();
+  this->m_HalfEdgeNeighbors.clear();
+  this->RemoveExternalWeldFiles();
+
+  this->m_ReadFromWeldedMeshCache = this->CanUseWeldedMeshCache() && this->ReadWeldedMeshCache();
+  if (this->m_ReadFromWeldedMeshCache)
+  {
+    // Release the mesh of an earlier read, so that none of it is mistaken
+    // for the cached one.
+    this->InitializeWeldedMesh();
+    return;
+  }
+
+  // Use default filetype. Opening the file also closes the stream that a
+  // read that failed may have left open.
+  bool opened = false;
+  if (this->GetFileType() == IOFileEnum::ASCII)
+  {
+    opened = this->OpenInputStream(std::ios::in);
+  }
+  else if (this->GetFileType() == IOFileEnum::BINARY)
+  {
+    opened = this->OpenInputStream(std::ios::in | std::ios::binary);
+  }
+
+  if (!opened)
+  {
+    itkExceptionMacro("Unable to open file\n"
+                      "inputFilename= "
+                      << this->m_FileName);
+    return;
+  }
+
+
+  // Read STL header file(the first line)
+  char headerBuffer[6];
+  this->m_InputStream.read(headerBuffer, 6);
+  this->m_InputStream.seekg(0); // Reset to the beginning of the file.
+
+  headerBuffer[5] = '\0';
+  std::string header(headerBuffer);
+
+  bool inputFileIsASCII = false;
+
+  // Based on the header line define whether the file is ASCII or BINARY
+  if (header.find("solid") != std::string::npos)
+  {
+    inputFileIsASCII = true;
+  }
+
+  // Determine file type
+  if (inputFileIsASCII)
+  {
+    if (this->GetFileType() != IOFileEnum::ASCII)
+    {
+      this->SetFileType(IOFileEnum::ASCII);
+#ifdef _WIN32
+      if (!this->OpenInputStream(std::ios::in))
+      {
+        itkExceptionMacro("Unable to open file\n"
+                          "inputFilename= "
+                          << this->m_FileName);
+        return;
+      }
+#endif
+    }
+
+    this->ReadMeshInternalFromAscii();
+  }
+  else
+  {
+    if (this->GetFileType() != IOFileEnum::BINARY)
+    {
+      this->SetFileType(IOFileEnum::BINARY);
+#ifdef _WIN32
+      if (!this->OpenInputStream(std::ios::in | std::ios::binary))
+      {
+        itkExceptionMacro("Unable to open file\n"
+                          "inputFilename= "
+                          << this->m_FileName);
+        return;
+      }
+#endif
+    }
+
+    if (this->m_DeferParsing)
+    {
+      // Until the triangles are decoded, the number of points is bounded by
+      // the number of vertices, enough to allocate the buffer of ReadPoints().
+      const int32_t numberOfTriangles = this->ReadHeaderFromBinary();
+      this->SetNumberOfPoints(3 * static_cast<SizeValueType>(numberOfTriangles));
+      this->m_ParsingPending = true;
+    }
+    else
+    {
+      this->ReadMeshInternalFromBinary();
+    }
+  }
+
+  this->CloseInputStream();
+}
+
+
+bool
+STLMeshIO ::OpenInputStream(std::ios::openmode mode)
+{
+  this->CloseInputStream();
+
+  if (this->m_InputBuffer != nullptr)
+  {
+    this->m_InputStreamBuffer = std::make_unique<MemoryReadBuffer>(this->m_InputBuffer, this->m_InputBufferSize);
+  }
+
+#if defined(__linux__)
+  if (!this->m_InputStreamBuffer && this->m_UseDirectRead)
+  {
+    auto buffer = std::make_unique<DirectReadBuffer>();
+    if (buffer->Open(this->m_FileName))
+    {
+      this->m_InputStreamBuffer = std::move(buffer);
+    }
+  }
+#endif
+
+  if (!this->m_InputStreamBuffer)
+  {
+    auto buffer = std::make_unique<std::filebuf>();
+    if (!buffer->open(this->m_FileName.c_str(), mode))
+    {
+      return false;
+    }
+    this->m_InputStreamBuffer = std::move(buffer);
+  }
+
+  // Attaching the buffer also clears the state of the stream.
+  this->m_InputStream.rdbuf(this->m_InputStreamBuffer.get());
+  return true;
+}
+
+
+void
+STLMeshIO ::CloseInputStream()
+{
+  this->m_InputStream.rdbuf(nullptr);
+  this->m_InputStreamBuffer.reset();
+}
+
+
+void
+STLMeshIO ::ReadDeferredMeshInternal()
+{
+  if (!this->m_ParsingPending)
+  {
+    return;
+  }
+
+  this->m_ParsingPending = false;
+
+  if (!this->OpenInputStream(std::ios::in | std::ios::binary))
+  {
+    itkExceptionMacro("Unable to open file\n"
+                      "inputFilename= "
+                      << this->m_FileName);
+  }
+
+  this->ReadMeshInternalFromBinary();
+
+  this->CloseInputStream();
+}
+
+
+void
+STLMeshIO ::ReadMeshInternalFromAscii()
+{
+  if (this->m_UseExternalMemoryWeld && !this->IsPreview())
+  {
+    itkExceptionMacro("UseExternalMemoryWeld is only available for binary STL files\n"
+                      "inputFilename= "
+                      << this->m_FileName);
+  }
+
+  // Read all the points, and reduce them to unique ones
+  PointType p0;
+  PointType p1;
+  PointType p2;
+
+  this->m_InputLineNumber = 2;
+
+  this->InitializeWeldedMesh();
+
+  this->m_Statistics.Initialize();
+
+  this->InitializeTriangleFilter();
+
+  // read header line
+  std::getline(this->m_InputStream, this->m_InputLine, '\n');
+
+  while (!this->CheckStringFromAscii("endsolid"))
+  {
+    //
+    // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
+    //
+    //  facet normal ni nj nk
+    //      outer loop
+    //          vertex v1x v1y v1z
+    //          vertex v2x v2y v2z
+    //          vertex v3x v3y v3z
+    //      endloop
+    //  endfacet
+    //
+    this->ReadStringFromAscii("facet normal");
+    this->ReadStringFromAscii("outer loop");
+    this->ReadPointAsAscii(p0);
+    this->ReadPointAsAscii(p1);
+    this->ReadPointAsAscii(p2);
+    this->ReadStringFromAscii("endloop");
+    this->ReadStringFromAscii("endfacet");
+
+    if (!this->AcceptTriangle(p0, p1, p2))
+    {
+      continue;
+    }
+
+    if (this->m_RemoveDegenerateTriangles && this->IsDegenerateTriangle(p0, p1, p2))
+    {
+      ++this->m_NumberOfRemovedDegenerateTriangles;
+      continue;
+    }
+
+    if (this->m_ComputeStatistics)
+    {
+      this->m_Statistics.AddTriangle(p0, p1, p2);
+    }
+
+    this->InsertTriangle(p0, p1, p2);
+  }
+
+  this->FinishReadMeshInternal();
+}
+
+
+void
+STLMeshIO ::ReadStringFromAscii(const std::string & expected)
+{
+  if (this->m_InputLine.empty())
+  {
+    std::getline(this->m_InputStream, this->m_InputLine, '\n');
+  }
+
+  if (this->m_InputLine.find(expected) == std::string::npos)
+  {
+    itkExceptionMacro("Parsing error: missed " << expected << " in line " << this->m_InputLineNumber
+                                               << " found: " << this->m_InputLine);
+  }
+
+  this->m_InputLine.clear();
+
+  this->m_InputLineNumber++;
+}
+
+
+void
+STLMeshIO ::ReadFacetFromAscii(FacetType & facet)
+{
+  if (this->m_InputLine.empty())
+  {
+    std::getline(this->m_InputStream, this->m_InputLine, '\n');
+  }
+
+  // The normal follows the keywords on the first line of the facet.
+  const std::string::size_type position = this->m_InputLine.find("facet normal");
+  if (position == std::string::npos)
+  {
+    itkExceptionMacro("Parsing error: missed facet normal in line " << this->m_InputLineNumber
+                                                                     << " found: " << this->m_InputLine);
+  }
+
+  const char * text = this->m_InputLine.c_str() + position + 12;
+  const char * end = this->m_InputLine.c_str() + this->m_InputLine.size();
+  for (float & value : facet.m_Normal)
+  {
+    text = ParseAsciiFloat(text, end, value);
+    if (text == nullptr)
+    {
+      itkExceptionMacro("Parsing error: missed normal component in line " << this->m_InputLineNumber
+                                                                          << " found: " << this->m_InputLine);
+    }
+  }
+
+  this->m_InputLine.clear();
+  this->m_InputLineNumber++;
+
+  this->ReadStringFromAscii("outer loop");
+  PointType point;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    this->ReadPointAsAscii(point);
+    for (unsigned int j = 0; j < 3; ++j)
+    {
+      facet.m_Vertices[3 * i + j] = point[j];
+    }
+  }
+  this->ReadStringFromAscii("endloop");
+  this->ReadStringFromAscii("endfacet");
+
+  facet.m_AttributeByteCount = 0;
+}
+
+
+bool
+STLMeshIO ::CheckStringFromAscii(const std::string & expected)
+{
+  std::getline(this->m_InputStream, this->m_InputLine, '\n');
+
+  if (this->m_InputLine.find(expected) != std::string::npos)
+  {
+    this->m_InputLineNumber++;
+    return true;
+  }
+
+  return false;
+}
+
+
+int32_t
+STLMeshIO ::ReadHeaderFromBinary()
+{
+  //
+  // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
+  //
+  // UINT8[80] header
+  //
+  char header[80];
+  this->m_InputStream.read(header, 80);
+
+  header[79] = '\0'; // insert string terminator
+
+  //
+  // UINT32 -- Number of Triangles
+  //
+  int32_t numberOfTriangles;
+  this->ReadInt32AsBinary(numberOfTriangles);
+
+  if (!this->m_InputStream)
+  {
+    itkExceptionMacro("Unable to read the header of binary STL file\n"
+                      "inputFilename= "
+                      << this->m_FileName);
+  }
+
+  //
+  // Every triangle record takes 50 bytes after the 84-byte header
+  //
+  const auto fileSize = this->m_InputBuffer != nullptr
+                          ? uint64_t{ this->m_InputBufferSize }
+                          : static_cast<uint64_t>(itksys::SystemTools::FileLength(this->m_FileName));
+  if (numberOfTriangles < 0 ||
+      fileSize < BinaryHeaderSize + BinaryTriangleRecordSize * static_cast<uint64_t>(numberOfTriangles))
+  {
+    itkExceptionMacro("Binary STL file is truncated: the header announces "
+                      << static_cast<uint32_t>(numberOfTriangles) << " triangles\n"
+                      << "inputFilename= " << this->m_FileName);
+  }
+
+  this->SetNumberOfCells(numberOfTriangles);
+
+  //
+  // The factor 5 accounts for five integers per triangle,
+  // see ReadMeshInternalFromBinary().
+  //
+  this->SetCellBufferSize(5 * static_cast<SizeValueType>(numberOfTriangles));
+
+  return numberOfTriangles;
+}
+
+
+void
+STLMeshIO ::ReadMeshInternalFromBinary()
+{
+  this->InitializeWeldedMesh();
+
+  const auto numberOfTriangles = static_cast<SizeValueType>(this->ReadHeaderFromBinary());
+
+  this->m_Statistics.Initialize();
+
+  this->InitializeTriangleFilter();
+
+  if (this->m_UseExternalMemoryWeld && !this->IsPreview())
+  {
+    this->WeldExternally(numberOfTriangles);
+    return;
+  }
+
+  //
+  // Ranges [first, first + count) of triangle records to be read.
+  //
+  std::vector<std::pair<SizeValueType, SizeValueType>> ranges;
+
+  bool useIndexedRanges = false;
+
+  if (this->m_UseSpatialIndex && this->m_InputBuffer == nullptr)
+  {
+    SpatialIndexType index;
+
+    if (!this->ReadSpatialIndex(numberOfTriangles, index))
+    {
+      this->BuildSpatialIndex(numberOfTriangles, index);
+      this->WriteSpatialIndex(numberOfTriangles, index);
+    }
+
+    if (this->m_UseRegionOfInterest)
+    {
+      this->QuerySpatialIndex(index, ranges);
+      useIndexedRanges = true;
+    }
+  }
+
+  if (!useIndexedRanges)
+  {
+    ranges.emplace_back(0, numberOfTriangles);
+  }
+
+  // Every triangle is kept unless some are filtered out, and closed
+  // meshes have about half as many points as triangles.
+  if (!this->m_UseRegionOfInterest && !this->m_TrianglePredicate)
+  {
+    if (!this->m_ReadPointsOnly)
+    {
+      this->m_CellsVector.reserve(numberOfTriangles);
+    }
+    this->m_WeldedPoints.reserve(numberOfTriangles / 2);
+    this->m_PointIndex.reserve(numberOfTriangles / 2, this->m_WeldedPoints);
+  }
+
+  for (const auto & range : ranges)
+  {
+    this->m_InputStream.seekg(BinaryHeaderSize + BinaryTriangleRecordSize * range.first);
+    this->ReadTrianglesFromBinary(range.second);
+  }
+
+  this->FinishReadMeshInternal();
+}
+
+
+const char *
+STLMeshIO ::ReadRecordsFromBinary(SizeValueType numberOfTriangles)
+{
+  const char * records = this->m_RecordsBuffer.data();
+
+  if (this->m_InputBuffer != nullptr)
+  {
+    // The records are decoded in the memory of the caller.
+    records = static_cast<MemoryReadBuffer *>(this->m_InputStreamBuffer.get())
+                ->Consume(BinaryTriangleRecordSize * numberOfTriangles);
+  }
+  else if (!this->m_InputStream.read(this->m_RecordsBuffer.data(), BinaryTriangleRecordSize * numberOfTriangles))
+  {
+    records = nullptr;
+  }
+
+  if (records == nullptr)
+  {
+    itkExceptionMacro("Unable to read triangles from binary STL file\n"
+                      "inputFilename= "
+                      << this->m_FileName);
+  }
+
+  return records;
+}
+
+
+void
+STLMeshIO ::ReadBlockFromBinary(SizeValueType numberOfTriangles)
+{
+  const char * records = this->ReadRecordsFromBinary(numberOfTriangles);
+
+  //
+  // foreach triangle
+  //
+  //    REAL32[3] – Normal vector
+  //    REAL32[3] – Vertex 1
+  //    REAL32[3] – Vertex 2
+  //    REAL32[3] – Vertex 3
+  //    UINT16 – Attribute byte count
+  //
+  for (SizeValueType t = 0; t < numberOfTriangles; ++t)
+  {
+    const char * record = records + BinaryTriangleRecordSize * t;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      this->ReadPointAsBinary(record + 12 * (i + 1), this->m_VerticesBuffer[3 * t + i]);
+    }
+  }
+}
+
+
+void
+STLMeshIO ::ReadTrianglesFromBinary(SizeValueType numberOfTriangles)
+{
+  //
+  // The triangles are read in blocks of records. Each block is decoded,
+  // its triangles are filtered and their statistics are reduced in
+  // parallel, and then the points of the accepted triangles are merged.
+  //
+  this->m_RecordsBuffer.resize(BinaryTriangleRecordSize * BinaryTrianglesPerBlock);
+  this->m_VerticesBuffer.resize(3 * BinaryTrianglesPerBlock);
+
+  std::vector<char> accepted(BinaryTrianglesPerBlock, 1);
+
+  const bool filterTriangles =
+    this->m_UseRegionOfInterest || this->m_TrianglePredicate || this->m_RemoveDegenerateTriangles;
+
+  MultiThreaderBase::Pointer  multiThreader;
+  std::vector<StatisticsType> partialStatistics;
+  std::vector<SizeValueType>  partialDegenerateCounts;
+  if (this->m_ComputeStatistics || filterTriangles)
+  {
+    multiThreader = MultiThreaderBase::New();
+    partialStatistics.resize(multiThreader->GetNumberOfWorkUnits());
+    partialDegenerateCounts.resize(multiThreader->GetNumberOfWorkUnits());
+  }
+
+  const std::vector<PointType> & vertices = this->m_VerticesBuffer;
+
+  SizeValueType remainingTriangles = numberOfTriangles;
+
+  while (remainingTriangles > 0)
+  {
+    const SizeValueType numberOfTrianglesInBlock = std::min(remainingTriangles, BinaryTrianglesPerBlock);
+    remainingTriangles -= numberOfTrianglesInBlock;
+
+    this->ReadBlockFromBinary(numberOfTrianglesInBlock);
+
+    if (multiThreader)
+    {
+      // Each work unit processes its own range of the block.
+      const SizeValueType numberOfWorkUnits = partialStatistics.size();
+      multiThreader->ParallelizeArray(
+        0,
+        numberOfWorkUnits,
+        [&](SizeValueType workUnit) {
+          StatisticsType & statistics = partialStatistics[workUnit];
+          statistics.Initialize();
+          partialDegenerateCounts[workUnit] = 0;
+          const SizeValueType first = numberOfTrianglesInBlock * workUnit / numberOfWorkUnits;
+          const SizeValueType last = numberOfTrianglesInBlock * (workUnit + 1) / numberOfWorkUnits;
+          for (SizeValueType t = first; t < last; ++t)
+          {
+            const PointType & p0 = vertices[3 * t];
+            const PointType & p1 = vertices[3 * t + 1];
+            const PointType & p2 = vertices[3 * t + 2];
+
+            accepted[t] = this->AcceptTriangle(p0, p1, p2);
+
+            if (accepted[t] && this->m_RemoveDegenerateTriangles && this->IsDegenerateTriangle(p0, p1, p2))
+            {
+              accepted[t] = 0;
+              ++partialDegenerateCounts[workUnit];
+            }
+
+            if (accepted[t] && this->m_ComputeStatistics)
+            {
+              statistics.AddTriangle(p0, p1, p2);
+            }
+          }
+        },
+        nullptr);
+
+      if (this->m_ComputeStatistics)
+      {
+        for (const StatisticsType & statistics : partialStatistics)
+        {
+          this->m_Statistics.Merge(statistics);
+        }
+      }
+
+      for (const SizeValueType degenerateCount : partialDegenerateCounts)
+      {
+        this->m_NumberOfRemovedDegenerateTriangles += degenerateCount;
+      }
+    }
+
+    for (SizeValueType t = 0; t < numberOfTrianglesInBlock; ++t)
+    {
+      if (accepted[t])
+      {
+        this->InsertTriangle(vertices[3 * t], vertices[3 * t + 1], vertices[3 * t + 2]);
+      }
+    }
+  }
+}
+
+
+std::string
+STLMeshIO ::GetCompanionFileName(const char * extension) const
+{
+  const std::string path = itksys::SystemTools::GetFilenamePath(this->m_FileName);
+  const std::string name = itksys::SystemTools::GetFilenameWithoutLastExtension(this->m_FileName) + extension;
+
+  return path.empty() ? name : path + "/" + name;
+}
+
+
+bool
+STLMeshIO ::ReadSpatialIndex(SizeValueType numberOfTriangles, SpatialIndexType & index)
+{
+  std::ifstream indexStream(this->GetCompanionFileName(".stlidx").c_str(), std::ios::in | std::ios::binary);
+
+  if (!indexStream.is_open())
+  {
+    return false;
+  }
+
+  SpatialIndexHeaderType header;
+  indexStream.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+  //
+  // The index is only valid for the exact same version of the STL file.
+  //
+  if (!indexStream || std::memcmp(header.m_Magic, SpatialIndexMagic, sizeof(header.m_Magic)) != 0 ||
+      header.m_FileSize != itksys::SystemTools::FileLength(this->m_FileName) ||
+      header.m_ModifiedTime != static_cast<int64_t>(itksys::SystemTools::ModifiedTime(this->m_FileName)) ||
+      header.m_NumberOfTriangles != numberOfTriangles)
+  {
+    return false;
+  }
+
+  index.resize(header.m_NumberOfTiles);
+
+  for (SpatialIndexTileType & tile : index)
+  {
+    uint32_t numberOfRanges = 0;
+    indexStream.read(reinterpret_cast<char *>(tile.m_Bounds), sizeof(tile.m_Bounds));
+    indexStream.read(reinterpret_cast<char *>(&numberOfRanges), sizeof(numberOfRanges));
+
+    if (!indexStream || numberOfRanges > numberOfTriangles)
+    {
+      return false;
+    }
+
+    tile.m_Ranges.resize(numberOfRanges);
+    indexStream.read(reinterpret_cast<char *>(tile.m_Ranges.data()), numberOfRanges * sizeof(SpatialIndexRangeType));
+
+    for (const SpatialIndexRangeType & range : tile.m_Ranges)
+    {
+      if (static_cast<SizeValueType>(range.m_First) + range.m_Count > numberOfTriangles)
+      {
+        return false;
+      }
+    }
+  }
+
+  return static_cast<bool>(indexStream);
+}
+
+
+void
+STLMeshIO ::BuildSpatialIndex(SizeValueType numberOfTriangles, SpatialIndexType & index)
+{
+  this->m_RecordsBuffer.resize(BinaryTriangleRecordSize * BinaryTrianglesPerBlock);
+  this->m_VerticesBuffer.resize(3 * BinaryTrianglesPerBlock);
+
+  const std::vector<PointType> & vertices = this->m_VerticesBuffer;
+
+  //
+  // First pass: bounding box of the vertices.
+  //
+  float lower[3];
+  float upper[3];
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    lower[i] = NumericTraits<float>::max();
+    upper[i] = NumericTraits<float>::NonpositiveMin();
+  }
+
+  this->m_InputStream.seekg(BinaryHeaderSize);
+  for (SizeValueType first = 0; first < numberOfTriangles; first += BinaryTrianglesPerBlock)
+  {
+    const SizeValueType numberOfTrianglesInBlock = std::min(numberOfTriangles - first, BinaryTrianglesPerBlock);
+
+    this->ReadBlockFromBinary(numberOfTrianglesInBlock);
+
+    for (SizeValueType v = 0; v < 3 * numberOfTrianglesInBlock; ++v)
+    {
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        lower[i] = std::min(lower[i], vertices[v][i]);
+        upper[i] = std::max(upper[i], vertices[v][i]);
+      }
+    }
+  }
+
+  //
+  // A uniform grid of tiles, with about a thousand triangles per tile.
+  //
+  const auto numberOfTilesPerAxis = static_cast<unsigned int>(
+    std::max(1.0, std::min(32.0, std::ceil(std::cbrt(static_cast<double>(numberOfTriangles) / 1024.0)))));
+
+  index.assign(numberOfTilesPerAxis * numberOfTilesPerAxis * numberOfTilesPerAxis, SpatialIndexTileType());
+
+  for (SpatialIndexTileType & tile : index)
+  {
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      tile.m_Bounds[2 * i] = NumericTraits<float>::max();
+      tile.m_Bounds[2 * i + 1] = NumericTraits<float>::NonpositiveMin();
+    }
+  }
+
+  //
+  // Second pass: every triangle goes to the tile of its centroid, and the
+  // bounds of the tile grow to contain the whole triangle. Consecutive
+  // triangles of the same tile are merged into a single range of records.
+  //
+  this->m_InputStream.seekg(BinaryHeaderSize);
+  for (SizeValueType first = 0; first < numberOfTriangles; first += BinaryTrianglesPerBlock)
+  {
+    const SizeValueType numberOfTrianglesInBlock = std::min(numberOfTriangles - first, BinaryTrianglesPerBlock);
+
+    this->ReadBlockFromBinary(numberOfTrianglesInBlock);
+
+    for (SizeValueType t = 0; t < numberOfTrianglesInBlock; ++t)
+    {
+      SizeValueType tileIndex = 0;
+      for (int i = 2; i >= 0; --i)
+      {
+        const float centroid = (vertices[3 * t][i] + vertices[3 * t + 1][i] + vertices[3 * t + 2][i]) / 3.0f;
+        const float extent = upper[i] - lower[i];
+
+        unsigned int cell = 0;
+        if (extent > 0.0f)
+        {
+          cell = std::min(numberOfTilesPerAxis - 1,
+                          static_cast<unsigned int>(std::max(0.0f, (centroid - lower[i]) / extent * numberOfTilesPerAxis)));
+        }
+        tileIndex = tileIndex * numberOfTilesPerAxis + cell;
+      }
+
+      SpatialIndexTileType & tile = index[tileIndex];
+
+      for (unsigned int k = 0; k < 3; ++k)
+      {
+        for (unsigned int i = 0; i < 3; ++i)
+        {
+          tile.m_Bounds[2 * i] = std::min(tile.m_Bounds[2 * i], vertices[3 * t + k][i]);
+          tile.m_Bounds[2 * i + 1] = std::max(tile.m_Bounds[2 * i + 1], vertices[3 * t + k][i]);
+        }
+      }
+
+      const auto triangleId = static_cast<uint32_t>(first + t);
+      if (!tile.m_Ranges.empty() && tile.m_Ranges.back().m_First + tile.m_Ranges.back().m_Count == triangleId)
+      {
+        ++tile.m_Ranges.back().m_Count;
+      }
+      else
+      {
+        tile.m_Ranges.push_back({ triangleId, 1 });
+      }
+    }
+  }
+
+  this->m_InputStream.seekg(BinaryHeaderSize);
+}
+
+
+void
+STLMeshIO ::WriteSpatialIndex(SizeValueType numberOfTriangles, const SpatialIndexType & index)
+{
+  const std::string indexFileName = this->GetCompanionFileName(".stlidx");
+
+  std::ofstream indexStream(indexFileName.c_str(), std::ios::out | std::ios::binary);
+
+  if (!indexStream.is_open())
+  {
+    itkWarningMacro("Unable to write the spatial index\n"
+                    "indexFilename= "
+                    << indexFileName);
+    return;
+  }
+
+  SpatialIndexHeaderType header;
+  std::memcpy(header.m_Magic, SpatialIndexMagic, sizeof(header.m_Magic));
+  header.m_FileSize = itksys::SystemTools::FileLength(this->m_FileName);
+  header.m_ModifiedTime = itksys::SystemTools::ModifiedTime(this->m_FileName);
+  header.m_NumberOfTriangles = numberOfTriangles;
+  header.m_NumberOfTiles = index.size();
+
+  indexStream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  for (const SpatialIndexTileType & tile : index)
+  {
+    const auto numberOfRanges = static_cast<uint32_t>(tile.m_Ranges.size());
+    indexStream.write(reinterpret_cast<const char *>(tile.m_Bounds), sizeof(tile.m_Bounds));
+    indexStream.write(reinterpret_cast<const char *>(&numberOfRanges), sizeof(numberOfRanges));
+    indexStream.write(reinterpret_cast<const char *>(tile.m_Ranges.data()),
+                      numberOfRanges * sizeof(SpatialIndexRangeType));
+  }
+
+  indexStream.close();
+
+  if (indexStream.fail())
+  {
+    itksys::SystemTools::RemoveFile(indexFileName);
+    itkWarningMacro("Unable to write the spatial index\n"
+                    "indexFilename= "
+                    << indexFileName);
+  }
+}
+
+
+void
+STLMeshIO ::QuerySpatialIndex(const SpatialIndexType &                               index,
+                              std::vector<std::pair<SizeValueType, SizeValueType>> & ranges) const
+{
+  ranges.clear();
+
+  for (const SpatialIndexTileType & tile : index)
+  {
+    bool overlaps = !tile.m_Ranges.empty();
+    for (unsigned int i = 0; i < 3 && overlaps; ++i)
+    {
+      overlaps = tile.m_Bounds[2 * i] <= this->m_RegionOfInterest[2 * i + 1] &&
+                 tile.m_Bounds[2 * i + 1] >= this->m_RegionOfInterest[2 * i];
+    }
+
+    if (overlaps)
+    {
+      for (const SpatialIndexRangeType & range : tile.m_Ranges)
+      {
+        ranges.emplace_back(range.m_First, range.m_Count);
+      }
+    }
+  }
+
+  //
+  // Read the records in file order, merging the adjacent ranges.
+  //
+  std::sort(ranges.begin(), ranges.end());
+
+  SizeValueType merged = 0;
+  for (SizeValueType r = 1; r < ranges.size(); ++r)
+  {
+    if (ranges[merged].first + ranges[merged].second == ranges[r].first)
+    {
+      ranges[merged].second += ranges[r].second;
+    }
+    else
+    {
+      ranges[++merged] = ranges[r];
+    }
+  }
+
+  if (!ranges.empty())
+  {
+    ranges.resize(merged + 1);
+  }
+}
+
+
+void
+STLMeshIO ::FinishReadMeshInternal()
+{
+  if (this->IsPreview())
+  {
+    this->FinishClusters();
+
+    // The clustered triangles were only needed to find the used clusters.
+    if (this->m_ReadPointsOnly)
+    {
+      this->m_CellsVector.clear();
+    }
+  }
+
+  if (this->m_ReorderForLocality)
+  {
+    this->ReorderAlongMortonCurve();
+  }
+
+  this->SetNumberOfPoints(this->m_WeldedPoints.size());
+  this->SetNumberOfCells(this->m_CellsVector.size());
+
+  //
+  // The factor 5 accounts for five integers
+  //  1. cell type id
+  //  2. number of points in cell
+  //  3. point id of point 0
+  //  4. point id of point 1
+  //  5. point id of point 2
+  //
+  this->SetCellBufferSize(5 * this->m_CellsVector.size());
+
+  if (this->m_ComputeStatistics)
+  {
+    this->PublishStatistics();
+  }
+
+  if (this->m_RemoveDegenerateTriangles || this->m_RemoveDuplicateTriangles)
+  {
+    MetaDataDictionary & dictionary = this->GetMetaDataDictionary();
+
+    EncapsulateMetaData<SizeValueType>(
+      dictionary, "STL_NumberOfRemovedDegenerateTriangles", this->m_NumberOfRemovedDegenerateTriangles);
+    EncapsulateMetaData<SizeValueType>(
+      dictionary, "STL_NumberOfRemovedDuplicateTriangles", this->m_NumberOfRemovedDuplicateTriangles);
+
+    // The keys are only needed while the triangles are inserted.
+    TriangleKeySetType().swap(this->m_TriangleKeys);
+  }
+
+  if (this->m_ComputeEdgeAdjacency)
+  {
+    this->BuildHalfEdgeAdjacency();
+  }
+
+  if (this->CanUseWeldedMeshCache())
+  {
+    this->WriteWeldedMeshCache();
+  }
+}
+
+
+void
+STLMeshIO ::BuildHalfEdgeAdjacency()
+{
+  const bool          fromCache = this->m_ReadFromWeldedMeshCache;
+  const SizeValueType numberOfTriangles =
+    fromCache ? this->m_CachedTriangles.size() / 3 : static_cast<SizeValueType>(this->m_CellsVector.size());
+  const SizeValueType numberOfHalfEdges = 3 * numberOfTriangles;
+
+  //
+  // Every half-edge 3 t + k goes from point k to point (k + 1) % 3 of
+  // triangle t. Its key is the pair of point Ids of its edge, smallest
+  // first, so that sorting the keys brings together the half-edges of the
+  // same edge.
+  //
+  std::vector<HalfEdgeKeyType> keys(numberOfHalfEdges);
+
+  constexpr SizeValueType halfEdgesPerWorkItem = 1 << 16;
+
+  const SizeValueType numberOfWorkItems = (numberOfHalfEdges + halfEdgesPerWorkItem - 1) / halfEdgesPerWorkItem;
+
+  MultiThreaderBase::Pointer multiThreader = MultiThreaderBase::New();
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfWorkItems,
+    [&](SizeValueType workItem) {
+      const SizeValueType first = workItem * halfEdgesPerWorkItem;
+      const SizeValueType last = std::min(first + halfEdgesPerWorkItem, numberOfHalfEdges);
+
+      IdentifierType pointIds[3];
+      for (SizeValueType h = first; h < last; ++h)
+      {
+        const SizeValueType t = h / 3;
+        if (fromCache)
+        {
+          std::copy_n(this->m_CachedTriangles.data() + 3 * t, 3, pointIds);
+        }
+        else
+        {
+          const TripletType triangle = this->m_CellsVector[t];
+          pointIds[0] = triangle.p0;
+          pointIds[1] = triangle.p1;
+          pointIds[2] = triangle.p2;
+        }
+
+        const IdentifierType origin = pointIds[h % 3];
+        const IdentifierType destination = pointIds[(h + 1) % 3];
+
+        keys[h].m_Lower = std::min(origin, destination);
+        keys[h].m_Upper = std::max(origin, destination);
+        keys[h].m_HalfEdge = h;
+      }
+    },
+    nullptr);
+
+  //
+  // Sort the keys: each work item sorts one slice, and the sorted slices
+  // are then merged pairwise, in parallel, until a single one remains.
+  //
+  const auto keyLess = [](const HalfEdgeKeyType & a, const HalfEdgeKeyType & b) {
+    return a.m_Lower != b.m_Lower ? a.m_Lower < b.m_Lower
+                                  : (a.m_Upper != b.m_Upper ? a.m_Upper < b.m_Upper : a.m_HalfEdge < b.m_HalfEdge);
+  };
+
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfWorkItems,
+    [&](SizeValueType workItem) {
+      const SizeValueType first = workItem * halfEdgesPerWorkItem;
+      const SizeValueType last = std::min(first + halfEdgesPerWorkItem, numberOfHalfEdges);
+      std::sort(keys.begin() + first, keys.begin() + last, keyLess);
+    },
+    nullptr);
+
+  for (SizeValueType width = halfEdgesPerWorkItem; width < numberOfHalfEdges; width *= 2)
+  {
+    const SizeValueType numberOfMerges = (numberOfHalfEdges + 2 * width - 1) / (2 * width);
+
+    multiThreader->ParallelizeArray(
+      0,
+      numberOfMerges,
+      [&](SizeValueType merge) {
+        const SizeValueType first = 2 * width * merge;
+        const SizeValueType middle = std::min(first + width, numberOfHalfEdges);
+        const SizeValueType last = std::min(first + 2 * width, numberOfHalfEdges);
+        std::inplace_merge(keys.begin() + first, keys.begin() + middle, keys.begin() + last, keyLess);
+      },
+      nullptr);
+  }
+
+  //
+  // Pair the two half-edges of every manifold edge. Edges with a single
+  // half-edge are on the boundary; edges shared by more than two triangles
+  // cannot be paired.
+  //
+  this->m_HalfEdgeNeighbors.assign(numberOfHalfEdges, BoundaryHalfEdge);
+
+  SizeValueType numberOfBoundaryEdges = 0;
+  SizeValueType numberOfNonManifoldEdges = 0;
+
+  for (SizeValueType first = 0; first < numberOfHalfEdges;)
+  {
+    SizeValueType last = first + 1;
+    while (last < numberOfHalfEdges && keys[last].m_Lower == keys[first].m_Lower &&
+           keys[last].m_Upper == keys[first].m_Upper)
+    {
+      ++last;
+    }
+
+    if (last - first == 1)
+    {
+      ++numberOfBoundaryEdges;
+    }
+    else if (last - first == 2)
+    {
+      this->m_HalfEdgeNeighbors[keys[first].m_HalfEdge] = keys[first + 1].m_HalfEdge;
+      this->m_HalfEdgeNeighbors[keys[first + 1].m_HalfEdge] = keys[first].m_HalfEdge;
+    }
+    else
+    {
+      ++numberOfNonManifoldEdges;
+      for (SizeValueType h = first; h < last; ++h)
+      {
+        this->m_HalfEdgeNeighbors[keys[h].m_HalfEdge] = NonManifoldHalfEdge;
+      }
+    }
+
+    first = last;
+  }
+
+  MetaDataDictionary & dictionary = this->GetMetaDataDictionary();
+
+  EncapsulateMetaData<SizeValueType>(dictionary, "STL_NumberOfBoundaryEdges", numberOfBoundaryEdges);
+  EncapsulateMetaData<SizeValueType>(dictionary, "STL_NumberOfNonManifoldEdges", numberOfNonManifoldEdges);
+}
+
+
+const STLMeshIO::HalfEdgeNeighborsType &
+STLMeshIO ::GetHalfEdgeNeighbors() const
+{
+  return this->m_HalfEdgeNeighbors;
+}
+
+
+bool
+STLMeshIO ::CanUseWeldedMeshCache() const
+{
+  // The cache holds the whole mesh: it cannot serve, nor be filled by,
+  // reads that discard triangles or decimate the mesh. The external weld
+  // keeps its mesh in scratch files, and orders the points differently.
+  return this->m_UseWeldedMeshCache && this->m_InputBuffer == nullptr && !this->m_ReadPointsOnly &&
+         !this->m_UseRegionOfInterest && !this->m_TrianglePredicate && !this->m_RemoveDegenerateTriangles &&
+         !this->m_RemoveDuplicateTriangles && !this->IsPreview() && !this->m_UseExternalMemoryWeld;
+}
+
+
+bool
+STLMeshIO ::ReadWeldedMeshCache()
+{
+  std::ifstream cacheStream(this->GetCompanionFileName(".stlcache").c_str(), std::ios::in | std::ios::binary);
+
+  if (!cacheStream.is_open())
+  {
+    return false;
+  }
+
+  WeldedMeshCacheHeaderType header;
+  cacheStream.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+  //
+  // The cache is only valid for the exact same version of the STL file,
+  // read with the same ordering of points and triangles.
+  //
+  if (!cacheStream || std::memcmp(header.m_Magic, WeldedMeshCacheMagic, sizeof(header.m_Magic)) != 0 ||
+      header.m_FileSize != itksys::SystemTools::FileLength(this->m_FileName) ||
+      header.m_ModifiedTime != static_cast<int64_t>(itksys::SystemTools::ModifiedTime(this->m_FileName)) ||
+      header.m_ReorderedForLocality != static_cast<uint32_t>(this->m_ReorderForLocality) ||
+      header.m_NumberOfTriangles > header.m_FileSize / BinaryTriangleRecordSize ||
+      header.m_NumberOfPoints > 3 * header.m_NumberOfTriangles)
+  {
+    return false;
+  }
+
+  this->m_CachedPoints.resize(3 * header.m_NumberOfPoints);
+  this->m_CachedTriangles.resize(3 * header.m_NumberOfTriangles);
+
+  cacheStream.read(reinterpret_cast<char *>(this->m_CachedPoints.data()), this->m_CachedPoints.size() * sizeof(float));
+  cacheStream.read(reinterpret_cast<char *>(this->m_CachedTriangles.data()),
+                   this->m_CachedTriangles.size() * sizeof(uint32_t));
+
+  const bool valid =
+    cacheStream && std::all_of(this->m_CachedTriangles.begin(),
+                               this->m_CachedTriangles.end(),
+                               [&header](uint32_t pointId) { return pointId < header.m_NumberOfPoints; });
+
+  if (!valid)
+  {
+    this->m_CachedPoints.clear();
+    this->m_CachedTriangles.clear();
+    return false;
+  }
+
+  this->SetFileType(header.m_FileType == 0 ? IOFileEnum::ASCII : IOFileEnum::BINARY);
+  this->SetNumberOfPoints(header.m_NumberOfPoints);
+  this->SetNumberOfCells(header.m_NumberOfTriangles);
+  this->SetCellBufferSize(5 * header.m_NumberOfTriangles);
+
+  if (this->m_ComputeStatistics)
+  {
+    this->m_Statistics.Initialize();
+
+    const auto cachedPoint = [this](uint32_t pointId) {
+      PointType point;
+      std::copy_n(this->m_CachedPoints.data() + 3 * pointId, 3, point.GetDataPointer());
+      return point;
+    };
+
+    for (SizeValueType t = 0; t < header.m_NumberOfTriangles; ++t)
+    {
+      const uint32_t * pointIds = this->m_CachedTriangles.data() + 3 * t;
+      this->m_Statistics.AddTriangle(cachedPoint(pointIds[0]), cachedPoint(pointIds[1]), cachedPoint(pointIds[2]));
+    }
+
+    this->PublishStatistics();
+  }
+
+  if (this->m_ComputeEdgeAdjacency)
+  {
+    this->BuildHalfEdgeAdjacency();
+  }
+
+  return true;
+}
+
+
+void
+STLMeshIO ::WriteWeldedMeshCache()
+{
+  // The cache stores 32-bit point Ids: a mesh whose point Ids needed the
+  // wide storage is not cached, and is welded again at every read.
+  if (this->m_CellsVector.IsWide())
+  {
+    return;
+  }
+
+  const std::string cacheFileName = this->GetCompanionFileName(".stlcache");
+
+  std::ofstream cacheStream(cacheFileName.c_str(), std::ios::out | std::ios::binary);
+
+  if (!cacheStream.is_open())
+  {
+    itkWarningMacro("Unable to write the welded mesh cache\n"
+                    "cacheFilename= "
+                    << cacheFileName);
+    return;
+  }
+
+  WeldedMeshCacheHeaderType header;
+  std::memcpy(header.m_Magic, WeldedMeshCacheMagic, sizeof(header.m_Magic));
+  header.m_FileSize = itksys::SystemTools::FileLength(this->m_FileName);
+  header.m_ModifiedTime = itksys::SystemTools::ModifiedTime(this->m_FileName);
+  header.m_FileType = this->GetFileType() == IOFileEnum::ASCII ? 0 : 1;
+  header.m_ReorderedForLocality = static_cast<uint32_t>(this->m_ReorderForLocality);
+  header.m_NumberOfPoints = this->m_WeldedPoints.size();
+  header.m_NumberOfTriangles = this->m_CellsVector.size();
+
+  std::vector<float> points(3 * this->m_WeldedPoints.size());
+  for (SizeValueType pointId = 0; pointId < this->m_WeldedPoints.size(); ++pointId)
+  {
+    std::copy_n(this->m_WeldedPoints[pointId].GetDataPointer(), 3, points.data() + 3 * pointId);
+  }
+
+  std::vector<uint32_t> triangles;
+  triangles.reserve(3 * this->m_CellsVector.size());
+  for (SizeValueType t = 0; t < this->m_CellsVector.size(); ++t)
+  {
+    const TripletType triangle = this->m_CellsVector[t];
+    triangles.push_back(static_cast<uint32_t>(triangle.p0));
+    triangles.push_back(static_cast<uint32_t>(triangle.p1));
+    triangles.push_back(static_cast<uint32_t>(triangle.p2));
+  }
+
+  cacheStream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  cacheStream.write(reinterpret_cast<const char *>(points.data()), points.size() * sizeof(float));
+  cacheStream.write(reinterpret_cast<const char *>(triangles.data()), triangles.size() * sizeof(uint32_t));
+
+  cacheStream.close();
+
+  if (cacheStream.fail())
+  {
+    itksys::SystemTools::RemoveFile(cacheFileName);
+    itkWarningMacro("Unable to write the welded mesh cache\n"
+                    "cacheFilename= "
+                    << cacheFileName);
+  }
+}
+
+
+void
+STLMeshIO ::WeldExternally(SizeValueType numberOfTriangles)
+{
+  if (this->m_RemoveDuplicateTriangles || this->m_ReorderForLocality || this->m_ComputeEdgeAdjacency)
+  {
+    itkExceptionMacro("UseExternalMemoryWeld cannot be combined with RemoveDuplicateTriangles, ReorderForLocality or "
+                      "ComputeEdgeAdjacency");
+  }
+
+  //
+  // 1. Decode the triangles, and spill their vertices to runs sorted by
+  //    coordinates, each one holding at most WeldMemoryBudget bytes.
+  //
+  const SizeValueType verticesPerRun = std::max<SizeValueType>(this->m_WeldMemoryBudget / sizeof(WeldVertexType), 3);
+
+  std::vector<WeldVertexType> run;
+  run.reserve(verticesPerRun);
+  std::vector<std::string> runFileNames;
+
+  const auto spillRun = [&]() {
+    std::sort(run.begin(), run.end(), WeldVertexLess);
+
+    runFileNames.push_back(this->GetScratchFileName(".run" + std::to_string(runFileNames.size())));
+    this->m_ScratchFileNames.push_back(runFileNames.back());
+
+    std::ofstream runStream(runFileNames.back().c_str(), std::ios::out | std::ios::binary);
+    runStream.write(reinterpret_cast<const char *>(run.data()), run.size() * sizeof(WeldVertexType));
+    if (!runStream)
+    {
+      itkExceptionMacro("Unable to write scratch file\n"
+                        "scratchFilename= "
+                        << runFileNames.back());
+    }
+    run.clear();
+  };
+
+  this->m_RecordsBuffer.resize(BinaryTriangleRecordSize * BinaryTrianglesPerBlock);
+  this->m_VerticesBuffer.resize(3 * BinaryTrianglesPerBlock);
+
+  uint64_t      numberOfKeptTriangles = 0;
+  SizeValueType remainingTriangles = numberOfTriangles;
+
+  while (remainingTriangles > 0)
+  {
+    const SizeValueType numberOfTrianglesInBlock = std::min(remainingTriangles, BinaryTrianglesPerBlock);
+    remainingTriangles -= numberOfTrianglesInBlock;
+
+    this->ReadBlockFromBinary(numberOfTrianglesInBlock);
+
+    for (SizeValueType t = 0; t < numberOfTrianglesInBlock; ++t)
+    {
+      const PointType * vertices = &this->m_VerticesBuffer[3 * t];
+
+      if (!this->AcceptTriangle(vertices[0], vertices[1], vertices[2]))
+      {
+        continue;
+      }
+
+      if (this->m_RemoveDegenerateTriangles && this->IsDegenerateTriangle(vertices[0], vertices[1], vertices[2]))
+      {
+        ++this->m_NumberOfRemovedDegenerateTriangles;
+        continue;
+      }
+
+      if (this->m_ComputeStatistics)
+      {
+        this->m_Statistics.AddTriangle(vertices[0], vertices[1], vertices[2]);
+      }
+
+      for (unsigned int k = 0; k < 3; ++k)
+      {
+        WeldVertexType vertex{};
+        std::copy_n(vertices[k].GetDataPointer(), 3, vertex.m_Coordinates);
+        vertex.m_Occurrence = 3 * numberOfKeptTriangles + k;
+        run.push_back(vertex);
+      }
+      ++numberOfKeptTriangles;
+
+      if (run.size() + 3 > verticesPerRun)
+      {
+        spillRun();
+      }
+    }
+  }
+
+  if (!run.empty())
+  {
+    spillRun();
+  }
+  std::vector<WeldVertexType>().swap(run);
+
+  // Merges the runs [first, last) in the order of WeldVertexLess, passes
+  // every vertex to the visitor, and removes the runs.
+  const auto mergeRuns = [&](SizeValueType first, SizeValueType last, auto && visitor) {
+    // Half of the budget is shared by the buffers of the runs.
+    const SizeValueType verticesPerBuffer = std::max<SizeValueType>(
+      this->m_WeldMemoryBudget / (2 * sizeof(WeldVertexType) * std::max<SizeValueType>(last - first, 1)), 1);
+
+    std::vector<std::unique_ptr<WeldRunReader>> readers;
+    for (SizeValueType r = first; r < last; ++r)
+    {
+      readers.emplace_back(new WeldRunReader(runFileNames[r], verticesPerBuffer));
+      if (!readers.back()->IsOpen())
+      {
+        itkExceptionMacro("Unable to read scratch file\n"
+                          "scratchFilename= "
+                          << runFileNames[r]);
+      }
+    }
+
+    const auto runGreater = [&readers](SizeValueType a, SizeValueType b) {
+      return WeldVertexLess(readers[b]->Current(), readers[a]->Current());
+    };
+    std::priority_queue<SizeValueType, std::vector<SizeValueType>, decltype(runGreater)> heap(runGreater);
+    for (SizeValueType r = 0; r < readers.size(); ++r)
+    {
+      if (readers[r]->IsValid())
+      {
+        heap.push(r);
+      }
+    }
+
+    while (!heap.empty())
+    {
+      const SizeValueType r = heap.top();
+      heap.pop();
+
+      visitor(readers[r]->Current());
+
+      readers[r]->Advance();
+      if (readers[r]->IsValid())
+      {
+        heap.push(r);
+      }
+    }
+
+    readers.clear();
+    for (SizeValueType r = first; r < last; ++r)
+    {
+      itksys::SystemTools::RemoveFile(runFileNames[r]);
+    }
+  };
+
+  //
+  // 2. Merge the runs, MaximumNumberOfOpenWeldFiles at a time, into longer
+  //    runs until they can all be merged at once.
+  //
+  SizeValueType numberOfRunFiles = runFileNames.size();
+
+  while (runFileNames.size() > MaximumNumberOfOpenWeldFiles)
+  {
+    std::vector<std::string> mergedRunFileNames;
+
+    for (SizeValueType first = 0; first < runFileNames.size(); first += MaximumNumberOfOpenWeldFiles)
+    {
+      mergedRunFileNames.push_back(this->GetScratchFileName(".run" + std::to_string(numberOfRunFiles++)));
+      this->m_ScratchFileNames.push_back(mergedRunFileNames.back());
+
+      std::ofstream mergedStream(mergedRunFileNames.back().c_str(), std::ios::out | std::ios::binary);
+      mergeRuns(first,
+                std::min<SizeValueType>(first + MaximumNumberOfOpenWeldFiles, runFileNames.size()),
+                [&mergedStream](const WeldVertexType & vertex) {
+                  mergedStream.write(reinterpret_cast<const char *>(&vertex), sizeof(vertex));
+                });
+
+      mergedStream.close();
+      if (!mergedStream)
+      {
+        itkExceptionMacro("Unable to write scratch file\n"
+                          "scratchFilename= "
+                          << mergedRunFileNames.back());
+      }
+    }
+
+    runFileNames.swap(mergedRunFileNames);
+  }
+
+  //
+  // 3. Merge the remaining runs. Equal consecutive vertices make one point,
+  //    written to the points file, and the Id of the point of every
+  //    occurrence is sent to the bucket of that occurrence. Reading only
+  //    the points needs no bucket. At most MaximumNumberOfOpenWeldFiles
+  //    files are written at once: the Ids go to groups of consecutive
+  //    buckets, which are split again until every group is one bucket.
+  //
+  const uint64_t      numberOfOccurrences = this->m_ReadPointsOnly ? 0 : 3 * numberOfKeptTriangles;
+  const SizeValueType occurrencesPerBucket = std::max<SizeValueType>(this->m_WeldMemoryBudget / sizeof(uint64_t), 1);
+  const SizeValueType numberOfBuckets = (numberOfOccurrences + occurrencesPerBucket - 1) / occurrencesPerBucket;
+
+  std::vector<std::string> bucketFileNames(numberOfBuckets);
+
+  // Files of the groups of consecutive buckets of [m_FirstBucket, m_LastBucket).
+  struct BucketGroupsType
+  {
+    SizeValueType            m_FirstBucket;
+    SizeValueType            m_LastBucket;
+    SizeValueType            m_BucketsPerGroup;
+    std::vector<std::string> m_FileNames;
+  };
+
+  const auto makeBucketGroups = [&](SizeValueType firstBucket, SizeValueType lastBucket) {
+    BucketGroupsType groups{ firstBucket,
+                             lastBucket,
+                             std::max<SizeValueType>((lastBucket - firstBucket + MaximumNumberOfOpenWeldFiles - 1) /
+                                                       MaximumNumberOfOpenWeldFiles,
+                                                     1),
+                             {} };
+    for (SizeValueType b = firstBucket; b < lastBucket; b += groups.m_BucketsPerGroup)
+    {
+      groups.m_FileNames.push_back(this->GetScratchFileName(".bucket" + std::to_string(b)));
+      this->m_ScratchFileNames.push_back(groups.m_FileNames.back());
+    }
+    return groups;
+  };
+
+  const auto closeBucketGroups = [this](WeldBucketWriter & writer) {
+    const std::string failedFileName = writer.Close();
+    if (!failedFileName.empty())
+    {
+      itkExceptionMacro("Unable to write scratch file\n"
+                        "scratchFilename= "
+                        << failedFileName);
+    }
+  };
+
+  std::vector<WeldPointIdType> entries(4096);
+
+  std::function<void(const BucketGroupsType &)> splitBucketGroups = [&](const BucketGroupsType & groups) {
+    for (SizeValueType g = 0; g < groups.m_FileNames.size(); ++g)
+    {
+      const SizeValueType firstBucket = groups.m_FirstBucket + g * groups.m_BucketsPerGroup;
+      const SizeValueType lastBucket = std::min(firstBucket + groups.m_BucketsPerGroup, groups.m_LastBucket);
+
+      if (lastBucket - firstBucket == 1)
+      {
+        bucketFileNames[firstBucket] = groups.m_FileNames[g];
+        continue;
+      }
+
+      const BucketGroupsType subgroups = makeBucketGroups(firstBucket, lastBucket);
+      WeldBucketWriter       writer(
+        subgroups.m_FileNames, firstBucket * occurrencesPerBucket, subgroups.m_BucketsPerGroup * occurrencesPerBucket);
+
+      std::ifstream groupStream(groups.m_FileNames[g].c_str(), std::ios::in | std::ios::binary);
+      do
+      {
+        groupStream.read(reinterpret_cast<char *>(entries.data()), entries.size() * sizeof(WeldPointIdType));
+        const SizeValueType count = groupStream.gcount() / sizeof(WeldPointIdType);
+        for (SizeValueType e = 0; e < count; ++e)
+        {
+          writer.Write(entries[e]);
+        }
+      } while (groupStream);
+
+      groupStream.close();
+      itksys::SystemTools::RemoveFile(groups.m_FileNames[g]);
+
+      closeBucketGroups(writer);
+      splitBucketGroups(subgroups);
+    }
+  };
+
+  const BucketGroupsType bucketGroups = makeBucketGroups(0, numberOfBuckets);
+  WeldBucketWriter       bucketWriter(
+    bucketGroups.m_FileNames, 0, bucketGroups.m_BucketsPerGroup * occurrencesPerBucket);
+
+  this->m_ExternalWeldPointsFileName = this->GetScratchFileName(".points");
+  this->m_ScratchFileNames.push_back(this->m_ExternalWeldPointsFileName);
+  std::ofstream pointsStream(this->m_ExternalWeldPointsFileName.c_str(), std::ios::out | std::ios::binary);
+
+  uint64_t numberOfPoints = 0;
+  float    lastCoordinates[3] = { 0.0f, 0.0f, 0.0f };
+
+  mergeRuns(0, runFileNames.size(), [&](const WeldVertexType & vertex) {
+    if (numberOfPoints == 0 || vertex.m_Coordinates[0] != lastCoordinates[0] ||
+        vertex.m_Coordinates[1] != lastCoordinates[1] || vertex.m_Coordinates[2] != lastCoordinates[2])
+    {
+      std::copy_n(vertex.m_Coordinates, 3, lastCoordinates);
+      pointsStream.write(reinterpret_cast<const char *>(lastCoordinates), sizeof(lastCoordinates));
+      ++numberOfPoints;
+    }
+
+    if (numberOfBuckets > 0)
+    {
+      bucketWriter.Write(WeldPointIdType{ vertex.m_Occurrence, numberOfPoints - 1 });
+    }
+  });
+
+  pointsStream.close();
+  if (!pointsStream)
+  {
+    itkExceptionMacro("Unable to write scratch file\n"
+                      "scratchFilename= "
+                      << this->m_ExternalWeldPointsFileName);
+  }
+
+  closeBucketGroups(bucketWriter);
+  splitBucketGroups(bucketGroups);
+
+  //
+  // 4. Scatter the point Ids of each bucket, in memory, to the order of
+  //    the occurrences, and append them to the triangles file.
+  //
+  this->m_ExternalWeldWideIds = numberOfPoints > std::numeric_limits<uint32_t>::max();
+
+  this->m_ExternalWeldTrianglesFileName = this->GetScratchFileName(".triangles");
+  this->m_ScratchFileNames.push_back(this->m_ExternalWeldTrianglesFileName);
+  std::ofstream trianglesStream(this->m_ExternalWeldTrianglesFileName.c_str(), std::ios::out | std::ios::binary);
+
+  std::vector<uint64_t> pointIds;
+  std::vector<uint32_t> narrowPointIds;
+
+  for (SizeValueType b = 0; b < numberOfBuckets; ++b)
+  {
+    const uint64_t firstOccurrence = b * occurrencesPerBucket;
+    pointIds.assign(std::min<uint64_t>(occurrencesPerBucket, numberOfOccurrences - firstOccurrence), 0);
+
+    std::ifstream bucketStream(bucketFileNames[b].c_str(), std::ios::in | std::ios::binary);
+    SizeValueType numberOfEntries = 0;
+    do
+    {
+      bucketStream.read(reinterpret_cast<char *>(entries.data()), entries.size() * sizeof(WeldPointIdType));
+      const SizeValueType count = bucketStream.gcount() / sizeof(WeldPointIdType);
+      for (SizeValueType e = 0; e < count; ++e)
+      {
+        pointIds[entries[e].m_Occurrence - firstOccurrence] = entries[e].m_PointId;
+      }
+      numberOfEntries += count;
+    } while (bucketStream);
+
+    if (numberOfEntries != pointIds.size())
+    {
+      itkExceptionMacro("Unable to read scratch file\n"
+                        "scratchFilename= "
+                        << bucketFileNames[b]);
+    }
+
+    bucketStream.close();
+    itksys::SystemTools::RemoveFile(bucketFileNames[b]);
+
+    if (this->m_ExternalWeldWideIds)
+    {
+      trianglesStream.write(reinterpret_cast<const char *>(pointIds.data()), pointIds.size() * sizeof(uint64_t));
+    }
+    else
+    {
+      narrowPointIds.assign(pointIds.begin(), pointIds.end());
+      trianglesStream.write(reinterpret_cast<const char *>(narrowPointIds.data()),
+                            narrowPointIds.size() * sizeof(uint32_t));
+    }
+  }
+
+  trianglesStream.close();
+  if (!trianglesStream)
+  {
+    itkExceptionMacro("Unable to write scratch file\n"
+                      "scratchFilename= "
+                      << this->m_ExternalWeldTrianglesFileName);
+  }
+
+  this->SetNumberOfPoints(numberOfPoints);
+  this->SetNumberOfCells(numberOfOccurrences / 3);
+  this->SetCellBufferSize(5 * (numberOfOccurrences / 3));
+
+  if (this->m_ComputeStatistics)
+  {
+    this->PublishStatistics();
+  }
+
+  if (this->m_RemoveDegenerateTriangles)
+  {
+    MetaDataDictionary & dictionary = this->GetMetaDataDictionary();
+
+    EncapsulateMetaData<SizeValueType>(
+      dictionary, "STL_NumberOfRemovedDegenerateTriangles", this->m_NumberOfRemovedDegenerateTriangles);
+    EncapsulateMetaData<SizeValueType>(
+      dictionary, "STL_NumberOfRemovedDuplicateTriangles", this->m_NumberOfRemovedDuplicateTriangles);
+  }
+}
+
+
+std::string
+STLMeshIO ::GetScratchFileName(const std::string & suffix) const
+{
+  const std::string directory = this->m_ScratchDirectory.empty()
+                                  ? itksys::SystemTools::GetFilenamePath(this->m_FileName)
+                                  : this->m_ScratchDirectory;
+
+  // A random token keeps the files of concurrent readers apart.
+  std::ostringstream name;
+  const std::string fileName = itksys::SystemTools::GetFilenameName(this->m_FileName);
+  name << (fileName.empty() ? "STLMeshIO" : fileName) << ".weld" << std::hex << std::random_device{}() << suffix;
+
+  return directory.empty() ? name.str() : directory + "/" + name.str();
+}
+
+
+void
+STLMeshIO ::RemoveExternalWeldFiles()
+{
+  for (const std::string & fileName : this->m_ScratchFileNames)
+  {
+    itksys::SystemTools::RemoveFile(fileName);
+  }
+  this->m_ScratchFileNames.clear();
+  this->m_ExternalWeldPointsFileName.clear();
+  this->m_ExternalWeldTrianglesFileName.clear();
+}
+
+
+void
+STLMeshIO ::ReadExternalWeldPoints(
+  const std::function<void(const float * coordinates, SizeValueType numberOfPoints)> & visitor) const
+{
+  std::ifstream pointsStream(this->m_ExternalWeldPointsFileName.c_str(), std::ios::in | std::ios::binary);
+
+  constexpr SizeValueType pointsPerChunk = 1 << 16;
+
+  std::vector<float> coordinates(3 * pointsPerChunk);
+
+  SizeValueType remainingPoints = this->GetNumberOfPoints();
+  while (remainingPoints > 0)
+  {
+    const SizeValueType numberOfPoints = std::min(remainingPoints, pointsPerChunk);
+    remainingPoints -= numberOfPoints;
+
+    pointsStream.read(reinterpret_cast<char *>(coordinates.data()), 3 * numberOfPoints * sizeof(float));
+
+    if (!pointsStream)
+    {
+      itkExceptionMacro("Unable to read scratch file\n"
+                        "scratchFilename= "
+                        << this->m_ExternalWeldPointsFileName);
+    }
+
+    visitor(coordinates.data(), numberOfPoints);
+  }
+}
+
+
+void
+STLMeshIO ::ReadExternalWeldTriangles(
+  const std::function<void(const uint64_t * pointIds, SizeValueType numberOfTriangles)> & visitor) const
+{
+  std::ifstream trianglesStream(this->m_ExternalWeldTrianglesFileName.c_str(), std::ios::in | std::ios::binary);
+
+  constexpr SizeValueType trianglesPerChunk = 1 << 16;
+
+  std::vector<uint64_t> pointIds(3 * trianglesPerChunk);
+  std::vector<uint32_t> narrowPointIds(this->m_ExternalWeldWideIds ? 0 : 3 * trianglesPerChunk);
+
+  SizeValueType remainingTriangles = this->GetNumberOfCells();
+  while (remainingTriangles > 0)
+  {
+    const SizeValueType numberOfTriangles = std::min(remainingTriangles, trianglesPerChunk);
+    remainingTriangles -= numberOfTriangles;
+
+    if (this->m_ExternalWeldWideIds)
+    {
+      trianglesStream.read(reinterpret_cast<char *>(pointIds.data()), 3 * numberOfTriangles * sizeof(uint64_t));
+    }
+    else
+    {
+      trianglesStream.read(reinterpret_cast<char *>(narrowPointIds.data()), 3 * numberOfTriangles * sizeof(uint32_t));
+      std::copy_n(narrowPointIds.begin(), 3 * numberOfTriangles, pointIds.begin());
+    }
+
+    if (!trianglesStream)
+    {
+      itkExceptionMacro("Unable to read scratch file\n"
+                        "scratchFilename= "
+                        << this->m_ExternalWeldTrianglesFileName);
+    }
+
+    visitor(pointIds.data(), numberOfTriangles);
+  }
+}
+
+
+void
+STLMeshIO ::ReorderAlongMortonCurve()
+{
+  const SizeValueType numberOfPoints = this->m_WeldedPoints.size();
+  const SizeValueType numberOfTriangles = this->m_CellsVector.size();
+
+  if (numberOfPoints == 0)
+  {
+    return;
+  }
+
+  //
+  // Compute the bounding box of the points.
+  //
+  double lower[3];
+  double upper[3];
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    lower[i] = NumericTraits<double>::max();
+    upper[i] = NumericTraits<double>::NonpositiveMin();
+  }
+
+  for (const PointType & point : this->m_WeldedPoints)
+  {
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      lower[i] = std::min(lower[i], double{ point[i] });
+      upper[i] = std::max(upper[i], double{ point[i] });
+    }
+  }
+
+  //
+  // Quantize the coordinates on 21 bits per axis, and interleave them
+  // into a 63-bit Morton (Z-order) code.
+  //
+  constexpr double maximumCoordinate = (1 << 21) - 1;
+
+  double scale[3];
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    scale[i] = upper[i] > lower[i] ? maximumCoordinate / (upper[i] - lower[i]) : 0.0;
+  }
+
+  const auto spreadBits = [](uint64_t value) {
+    value &= 0x1fffff;
+    value = (value | value << 32) & 0x1f00000000ffff;
+    value = (value | value << 16) & 0x1f0000ff0000ff;
+    value = (value | value << 8) & 0x100f00f00f00f00f;
+    value = (value | value << 4) & 0x10c30c30c30c30c3;
+    value = (value | value << 2) & 0x1249249249249249;
+    return value;
+  };
+
+  const auto mortonCode = [&](const double coordinates[3]) {
+    uint64_t code = 0;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      const auto quantized = static_cast<uint64_t>((coordinates[i] - lower[i]) * scale[i] + 0.5);
+      code |= spreadBits(quantized) << i;
+    }
+    return code;
+  };
+
+  MultiThreaderBase::Pointer multiThreader = MultiThreaderBase::New();
+
+  std::vector<uint64_t> pointCodes(numberOfPoints);
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfPoints,
+    [&](SizeValueType pointId) {
+      const PointType & point = this->m_WeldedPoints[pointId];
+      const double      coordinates[3] = { point[0], point[1], point[2] };
+      pointCodes[pointId] = mortonCode(coordinates);
+    },
+    nullptr);
+
+  //
+  // Sort the points along the curve. Ties are broken by the original Id,
+  // so that the result does not depend on the sorting algorithm.
+  //
+  std::vector<IdentifierType> order(numberOfPoints);
+  for (SizeValueType pointId = 0; pointId < numberOfPoints; ++pointId)
+  {
+    order[pointId] = pointId;
+  }
+
+  std::sort(order.begin(), order.end(), [&](IdentifierType a, IdentifierType b) {
+    return pointCodes[a] != pointCodes[b] ? pointCodes[a] < pointCodes[b] : a < b;
+  });
+
+  std::vector<IdentifierType> newIds(numberOfPoints);
+  for (SizeValueType k = 0; k < numberOfPoints; ++k)
+  {
+    newIds[order[k]] = k;
+  }
+
+  //
+  // Renumber the triangles, and sort them by the code of their centroid.
+  //
+  std::vector<uint64_t> triangleCodes(numberOfTriangles);
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfTriangles,
+    [&](SizeValueType t) {
+      TripletType triangle = this->m_CellsVector[t];
+
+      const PointType & p0 = this->m_WeldedPoints[triangle.p0];
+      const PointType & p1 = this->m_WeldedPoints[triangle.p1];
+      const PointType & p2 = this->m_WeldedPoints[triangle.p2];
+
+      double centroid[3];
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        centroid[i] = (double{ p0[i] } + double{ p1[i] } + double{ p2[i] }) / 3.0;
+      }
+      triangleCodes[t] = mortonCode(centroid);
+
+      triangle.p0 = newIds[triangle.p0];
+      triangle.p1 = newIds[triangle.p1];
+      triangle.p2 = newIds[triangle.p2];
+      this->m_CellsVector.SetTriangle(t, triangle);
+    },
+    nullptr);
+
+  std::vector<IdentifierType> triangleOrder(numberOfTriangles);
+  for (SizeValueType t = 0; t < numberOfTriangles; ++t)
+  {
+    triangleOrder[t] = t;
+  }
+
+  std::sort(triangleOrder.begin(), triangleOrder.end(), [&](IdentifierType a, IdentifierType b) {
+    return triangleCodes[a] != triangleCodes[b] ? triangleCodes[a] < triangleCodes[b] : a < b;
+  });
+
+  CellsVectorType reorderedCells;
+  reorderedCells.resize(numberOfTriangles, this->m_CellsVector.IsWide());
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfTriangles,
+    [&](SizeValueType t) { reorderedCells.SetTriangle(t, this->m_CellsVector[triangleOrder[t]]); },
+    nullptr);
+
+  this->m_CellsVector.swap(reorderedCells);
+
+  //
+  // Move the points to their new Ids.
+  //
+  PointContainerType reorderedPoints(numberOfPoints);
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfPoints,
+    [&](SizeValueType k) { reorderedPoints[k] = this->m_WeldedPoints[order[k]]; },
+    nullptr);
+
+  this->m_WeldedPoints.swap(reorderedPoints);
+  this->m_PointIndex.Remap(newIds);
+}
+
+
+void
+STLMeshIO ::CellsVectorType::reserve(SizeValueType numberOfTriangles)
+{
+  if (this->m_Wide)
+  {
+    this->m_WideIds.reserve(3 * numberOfTriangles);
+  }
+  else
+  {
+    this->m_Ids.reserve(3 * numberOfTriangles);
+  }
+}
+
+
+void
+STLMeshIO ::CellsVectorType::resize(SizeValueType numberOfTriangles, bool wide)
+{
+  this->clear();
+  this->m_Wide = wide;
+  if (wide)
+  {
+    this->m_WideIds.resize(3 * numberOfTriangles);
+  }
+  else
+  {
+    this->m_Ids.resize(3 * numberOfTriangles);
+  }
+}
+
+
+void
+STLMeshIO ::CellsVectorType::clear()
+{
+  this->m_Ids.clear();
+  this->m_WideIds.clear();
+  this->m_Wide = false;
+}
+
+
+void
+STLMeshIO ::CellsVectorType::swap(CellsVectorType & other) noexcept
+{
+  this->m_Ids.swap(other.m_Ids);
+  this->m_WideIds.swap(other.m_WideIds);
+  std::swap(this->m_Wide, other.m_Wide);
+}
+
+
+void
+STLMeshIO ::CellsVectorType::push_back(const TripletType & triangle)
+{
+  //
+  // Point Ids are assigned in increasing order, so the storage is widened
+  // at most once, when the first point Id beyond 32 bits appears.
+  //
+  if (!this->m_Wide && std::max({ triangle.p0, triangle.p1, triangle.p2 }) > std::numeric_limits<uint32_t>::max())
+  {
+    this->m_WideIds.assign(this->m_Ids.begin(), this->m_Ids.end());
+    std::vector<uint32_t>().swap(this->m_Ids);
+    this->m_Wide = true;
+  }
+
+  if (this->m_Wide)
+  {
+    this->m_WideIds.insert(this->m_WideIds.end(), { triangle.p0, triangle.p1, triangle.p2 });
+  }
+  else
+  {
+    this->m_Ids.insert(this->m_Ids.end(),
+                       { static_cast<uint32_t>(triangle.p0),
+                         static_cast<uint32_t>(triangle.p1),
+                         static_cast<uint32_t>(triangle.p2) });
+  }
+}
+
+
+auto
+STLMeshIO ::CellsVectorType::operator[](SizeValueType triangleId) const -> TripletType
+{
+  TripletType triangle;
+  if (this->m_Wide)
+  {
+    triangle.p0 = static_cast<IdentifierType>(this->m_WideIds[3 * triangleId]);
+    triangle.p1 = static_cast<IdentifierType>(this->m_WideIds[3 * triangleId + 1]);
+    triangle.p2 = static_cast<IdentifierType>(this->m_WideIds[3 * triangleId + 2]);
+  }
+  else
+  {
+    triangle.p0 = this->m_Ids[3 * triangleId];
+    triangle.p1 = this->m_Ids[3 * triangleId + 1];
+    triangle.p2 = this->m_Ids[3 * triangleId + 2];
+  }
+  return triangle;
+}
+
+
+void
+STLMeshIO ::CellsVectorType::SetTriangle(SizeValueType triangleId, const TripletType & triangle)
+{
+  if (this->m_Wide)
+  {
+    this->m_WideIds[3 * triangleId] = triangle.p0;
+    this->m_WideIds[3 * triangleId + 1] = triangle.p1;
+    this->m_WideIds[3 * triangleId + 2] = triangle.p2;
+  }
+  else
+  {
+    this->m_Ids[3 * triangleId] = static_cast<uint32_t>(triangle.p0);
+    this->m_Ids[3 * triangleId + 1] = static_cast<uint32_t>(triangle.p1);
+    this->m_Ids[3 * triangleId + 2] = static_cast<uint32_t>(triangle.p2);
+  }
+}
+
+
+SizeValueType
+STLMeshIO ::PointIndexType::Hash(const PointType & point)
+{
+  //
+  // Hash the bit patterns of the coordinates; adding zero maps -0 to +0,
+  // which compare equal.
+  //
+  uint64_t hash = 0;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    const float coordinate = point[i] + 0.0f;
+    uint32_t    bits;
+    std::memcpy(&bits, &coordinate, sizeof(bits));
+    hash = (hash ^ bits) * 0x9E3779B97F4A7C15ULL;
+  }
+  return static_cast<SizeValueType>(hash ^ (hash >> 32));
+}
+
+
+IdentifierType
+STLMeshIO ::PointIndexType::FindOrInsert(const PointType & point, PointContainerType & weldedPoints)
+{
+  // Keep the load factor at most one half.
+  if (2 * (this->m_NumberOfPoints + 1) > this->m_Slots.size())
+  {
+    this->Rehash(std::max<SizeValueType>(2 * this->m_Slots.size(), 1024), weldedPoints);
+  }
+
+  const SizeValueType mask = this->m_Slots.size() - 1;
+  SizeValueType       slot = Hash(point) & mask;
+
+  while (this->m_Slots[slot] != EmptySlot)
+  {
+    const PointType & other = weldedPoints[this->m_Slots[slot]];
+    if (other[0] == point[0] && other[1] == point[1] && other[2] == point[2])
+    {
+      return this->m_Slots[slot];
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  const IdentifierType pointId = weldedPoints.size();
+  weldedPoints.push_back(point);
+  this->m_Slots[slot] = pointId;
+  this->m_NumberOfPoints++;
+  return pointId;
+}
+
+
+void
+STLMeshIO ::PointIndexType::reserve(SizeValueType numberOfPoints, const PointContainerType & weldedPoints)
+{
+  SizeValueType numberOfSlots = 1024;
+  while (numberOfSlots < 2 * numberOfPoints)
+  {
+    numberOfSlots *= 2;
+  }
+
+  if (numberOfSlots > this->m_Slots.size())
+  {
+    this->Rehash(numberOfSlots, weldedPoints);
+  }
+}
+
+
+void
+STLMeshIO ::PointIndexType::clear()
+{
+  if (this->m_NumberOfPoints > 0)
+  {
+    std::fill(this->m_Slots.begin(), this->m_Slots.end(), EmptySlot);
+    this->m_NumberOfPoints = 0;
+  }
+}
+
+
+void
+STLMeshIO ::PointIndexType::Release()
+{
+  std::vector<IdentifierType>().swap(this->m_Slots);
+  this->m_NumberOfPoints = 0;
+}
+
+
+void
+STLMeshIO ::PointIndexType::Remap(const std::vector<IdentifierType> & newIds)
+{
+  for (IdentifierType & pointId : this->m_Slots)
+  {
+    if (pointId != EmptySlot)
+    {
+      pointId = newIds[pointId];
+    }
+  }
+}
+
+
+void
+STLMeshIO ::PointIndexType::Rehash(SizeValueType numberOfSlots, const PointContainerType & weldedPoints)
+{
+  this->m_Slots.assign(numberOfSlots, EmptySlot);
+
+  const SizeValueType mask = numberOfSlots - 1;
+  for (SizeValueType pointId = 0; pointId < this->m_NumberOfPoints; ++pointId)
+  {
+    SizeValueType slot = Hash(weldedPoints[pointId]) & mask;
+    while (this->m_Slots[slot] != EmptySlot)
+    {
+      slot = (slot + 1) & mask;
+    }
+    this->m_Slots[slot] = pointId;
+  }
+}
+
+
+void
+STLMeshIO ::StatisticsType::Initialize()
+{
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    this->m_Bounds[2 * i] = NumericTraits<double>::max();
+    this->m_Bounds[2 * i + 1] = NumericTraits<double>::NonpositiveMin();
+  }
+  this->m_SurfaceArea = 0.0;
+  this->m_Volume = 0.0;
+  this->m_NumberOfDegenerateTriangles = 0;
+}
+
+
+void
+STLMeshIO ::StatisticsType::AddTriangle(const PointType & p0, const PointType & p1, const PointType & p2)
+{
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    this->m_Bounds[2 * i] = std::min({ this->m_Bounds[2 * i], double{ p0[i] }, double{ p1[i] }, double{ p2[i] } });
+    this->m_Bounds[2 * i + 1] =
+      std::max({ this->m_Bounds[2 * i + 1], double{ p0[i] }, double{ p1[i] }, double{ p2[i] } });
+  }
+
+  // Accumulate in double precision, the vertices are only stored as floats.
+  const double a[3] = { p0[0], p0[1], p0[2] };
+  const double b[3] = { p1[0], p1[1], p1[2] };
+  const double c[3] = { p2[0], p2[1], p2[2] };
+
+  const double area = TriangleArea(p0, p1, p2);
+
+  if (area == 0.0)
+  {
+    ++this->m_NumberOfDegenerateTriangles;
+  }
+
+  this->m_SurfaceArea += area;
+
+  // Signed volume of the tetrahedron formed with the origin: a . (b x c) / 6
+  this->m_Volume += (a[0] * (b[1] * c[2] - b[2] * c[1]) + a[1] * (b[2] * c[0] - b[0] * c[2]) +
+                     a[2] * (b[0] * c[1] - b[1] * c[0])) /
+                    6.0;
+}
+
+
+void
+STLMeshIO ::StatisticsType::RemoveTriangle(const PointType & p0, const PointType & p1, const PointType & p2)
+{
+  StatisticsType removed;
+  removed.Initialize();
+  removed.AddTriangle(p0, p1, p2);
+
+  this->m_SurfaceArea -= removed.m_SurfaceArea;
+  this->m_Volume -= removed.m_Volume;
+  this->m_NumberOfDegenerateTriangles -= removed.m_NumberOfDegenerateTriangles;
+}
+
+
+void
+STLMeshIO ::StatisticsType::Merge(const StatisticsType & other)
+{
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    this->m_Bounds[2 * i] = std::min(this->m_Bounds[2 * i], other.m_Bounds[2 * i]);
+    this->m_Bounds[2 * i + 1] = std::max(this->m_Bounds[2 * i + 1], other.m_Bounds[2 * i + 1]);
+  }
+  this->m_SurfaceArea += other.m_SurfaceArea;
+  this->m_Volume += other.m_Volume;
+  this->m_NumberOfDegenerateTriangles += other.m_NumberOfDegenerateTriangles;
+}
+
+
+void
+STLMeshIO ::PublishStatistics()
+{
+  MetaDataDictionary & dictionary = this->GetMetaDataDictionary();
+
+  const std::vector<double> bounds(this->m_Statistics.m_Bounds, this->m_Statistics.m_Bounds + 6);
+
+  EncapsulateMetaData<std::vector<double>>(dictionary, "STL_BoundingBox", bounds);
+  EncapsulateMetaData<double>(dictionary, "STL_SurfaceArea", this->m_Statistics.m_SurfaceArea);
+  EncapsulateMetaData<double>(dictionary, "STL_Volume", this->m_Statistics.m_Volume);
+  EncapsulateMetaData<SizeValueType>(
+    dictionary, "STL_NumberOfDegenerateTriangles", this->m_Statistics.m_NumberOfDegenerateTriangles);
+}
+
+
+void
+STLMeshIO ::ReadPoints(void * buffer)
+{
+  this->ReadDeferredMeshInternal();
+
+  //
+  // The Point and Cell data were read in the ReadMeshInformation() method.
+  // Here, we can focus on packaging the point data into the return buffer.
+  //
+  switch (this->GetPointComponentType())
+  {
+    case IOComponentEnum::FLOAT:
+    {
+      using CoordType = float;
+      this->ReadPointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
+      break;
+    }
+    case IOComponentEnum::DOUBLE:
+    {
+      using CoordType = double;
+      this->ReadPointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
+      break;
+    }
+    default:
+    {
+      itkExceptionMacro("Points can only be read as FLOAT or DOUBLE coordinates");
+    }
+  }
+}
+
+
+void
+STLMeshIO ::ReadCells(void * buffer)
+{
+  this->ReadDeferredMeshInternal();
+
+  // The cell buffer is empty when only the points are read.
+  if (this->m_ReadPointsOnly)
+  {
+    return;
+  }
+
+  //
+  // The Point and Cell data were read in the ReadMeshInformation() method.
+  // Here, we can focus on packaging the cell data into the return buffer.
+  //
+  using CellIDType = unsigned int;
+  auto * cellPointIds = reinterpret_cast<CellIDType *>(buffer);
+
+  constexpr unsigned int numberOfPointsInCell = 3;
+
+  if (this->m_ReadFromWeldedMeshCache)
+  {
+    for (auto triangleItr = this->m_CachedTriangles.cbegin(); triangleItr != this->m_CachedTriangles.cend();)
+    {
+      *cellPointIds++ = static_cast<CellIDType>(CellGeometryEnum::TRIANGLE_CELL);
+      *cellPointIds++ = numberOfPointsInCell;
+      *cellPointIds++ = *triangleItr++;
+      *cellPointIds++ = *triangleItr++;
+      *cellPointIds++ = *triangleItr++;
+    }
+    return;
+  }
+
+  if (!this->m_ExternalWeldTrianglesFileName.empty())
+  {
+    this->ReadExternalWeldTriangles([&cellPointIds](const uint64_t * pointIds, SizeValueType numberOfTriangles) {
+      for (SizeValueType t = 0; t < numberOfTriangles; ++t)
+      {
+        *cellPointIds++ = static_cast<CellIDType>(CellGeometryEnum::TRIANGLE_CELL);
+        *cellPointIds++ = numberOfPointsInCell;
+        *cellPointIds++ = static_cast<CellIDType>(*pointIds++);
+        *cellPointIds++ = static_cast<CellIDType>(*pointIds++);
+        *cellPointIds++ = static_cast<CellIDType>(*pointIds++);
+      }
+    });
+    return;
+  }
+
+  const SizeValueType numberOfTriangles = this->m_CellsVector.size();
+
+  for (SizeValueType t = 0; t < numberOfTriangles; ++t)
+  {
+    const TripletType triangle = this->m_CellsVector[t];
+
+    *cellPointIds++ = static_cast<CellIDType>(CellGeometryEnum::TRIANGLE_CELL);
+    *cellPointIds++ = numberOfPointsInCell;
+
+    //
+    // Store the Point Ids for this cell, in the buffer.
+    //
+    *cellPointIds++ = static_cast<CellIDType>(triangle.p0);
+    *cellPointIds++ = static_cast<CellIDType>(triangle.p1);
+    *cellPointIds++ = static_cast<CellIDType>(triangle.p2);
+  }
+}
+
+
+void
+STLMeshIO ::ReadTriangles(void * buffer, IOComponentEnum componentType)
+{
+  this->ReadDeferredMeshInternal();
+
+  if (this->m_ReadPointsOnly)
+  {
+    return;
+  }
+
+  switch (componentType)
+  {
+    case IOComponentEnum::UINT:
+      this->ReadTrianglesTyped(reinterpret_cast<unsigned int *>(buffer));
+      break;
+    case IOComponentEnum::ULONG:
+      this->ReadTrianglesTyped(reinterpret_cast<unsigned long *>(buffer));
+      break;
+    case IOComponentEnum::ULONGLONG:
+      this->ReadTrianglesTyped(reinterpret_cast<unsigned long long *>(buffer));
+      break;
+    default:
+      itkExceptionMacro("Unsupported triangle component type: " << componentType);
+  }
+}
+
+
+SizeValueType
+STLMeshIO ::Transcode(const std::string & outputFileName, IOFileEnum outputFileType)
+{
+  if (!this->OpenInputStream(std::ios::in | std::ios::binary))
+  {
+    itkExceptionMacro("Unable to open file\n"
+                      "inputFilename= "
+                      << this->m_FileName);
+  }
+
+  // The same test on the first bytes as ReadMeshInformation().
+  char headerBuffer[6] = {};
+  this->m_InputStream.read(headerBuffer, 5);
+  this->m_InputStream.seekg(0);
+
+  const bool inputFileIsASCII = std::string(headerBuffer).find("solid") != std::string::npos;
+
+  SizeValueType numberOfFacets = 0;
+  if (inputFileIsASCII)
+  {
+    std::getline(this->m_InputStream, this->m_InputLine, '\n');
+    this->m_InputLine.clear();
+    this->m_InputLineNumber = 2;
+  }
+  else
+  {
+    numberOfFacets = static_cast<uint32_t>(this->ReadHeaderFromBinary());
+    this->m_RecordsBuffer.resize(BinaryTriangleRecordSize * BinaryTrianglesPerBlock);
+  }
+
+  //
+  // The header is written before the facets. The number of facets of an
+  // ASCII file is only known once it has been parsed: it is patched in
+  // the binary output at the end.
+  //
+  this->m_OutputChunk.clear();
+  this->m_OutputChunk.reserve(OutputChunkSize);
+
+  if (this->m_OutputBuffer != nullptr)
+  {
+    this->m_OutputBuffer->clear();
+  }
+  else
+  {
+    this->m_OutputStream.open(outputFileName.c_str(),
+                              outputFileType == IOFileEnum::ASCII ? std::ios::out : std::ios::out | std::ios::binary);
+    if (!this->m_OutputStream.is_open())
+    {
+      this->CloseInputStream();
+      itkExceptionMacro("Unable to open file\n"
+                        "outputFilename= "
+                        << outputFileName);
+    }
+  }
+
+  if (outputFileType == IOFileEnum::ASCII)
+  {
+    constexpr char header[] = "solid ascii\n";
+    this->WriteToOutput(header, sizeof(header) - 1);
+  }
+  else
+  {
+    char header[80];
+    FormatBinaryHeader(header);
+    this->WriteToOutput(header, sizeof(header));
+    this->WriteInt32AsBinary(static_cast<int32_t>(numberOfFacets));
+  }
+
+  //
+  // Ring of blocks of facets, filled by the calling thread and emptied by
+  // the writer thread. The blocks keep their capacity from one use to the
+  // next.
+  //
+  constexpr unsigned int  NumberOfBlocks = 4;
+  std::vector<FacetType>  blocks[NumberOfBlocks];
+  SizeValueType           head = 0;
+  SizeValueType           tail = 0;
+  bool                    done = false;
+  bool                    writerFailed = false;
+  std::mutex              mutex;
+  std::condition_variable condition;
+  std::exception_ptr      writerError;
+
+  auto writeBlocks = [&] {
+    try
+    {
+      for (;;)
+      {
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          condition.wait(lock, [&] { return tail < head || done; });
+          if (tail == head)
+          {
+            break;
+          }
+        }
+
+        const std::vector<FacetType> & block = blocks[tail % NumberOfBlocks];
+        this->WriteFacets(block.data(), block.size(), outputFileType);
+
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          ++tail;
+        }
+        condition.notify_all();
+      }
+    }
+    catch (...)
+    {
+      writerError = std::current_exception();
+      std::lock_guard<std::mutex> lock(mutex);
+      writerFailed = true;
+      condition.notify_all();
+    }
+  };
+  std::thread writer(writeBlocks);
+
+  // Wait for a free block, or return nullptr when the writer has failed.
+  auto acquireBlock = [&]() -> std::vector<FacetType> * {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&] { return head - tail < NumberOfBlocks || writerFailed; });
+    if (writerFailed)
+    {
+      return nullptr;
+    }
+    std::vector<FacetType> & block = blocks[head % NumberOfBlocks];
+    block.clear();
+    return &block;
+  };
+  auto publishBlock = [&] {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++head;
+    }
+    condition.notify_all();
+  };
+
+  std::exception_ptr readerError;
+  try
+  {
+    if (inputFileIsASCII)
+    {
+      std::vector<FacetType> * block = nullptr;
+      while (!this->CheckStringFromAscii("endsolid"))
+      {
+        if (block == nullptr && (block = acquireBlock()) == nullptr)
+        {
+          break;
+        }
+
+        block->emplace_back();
+        this->ReadFacetFromAscii(block->back());
+        ++numberOfFacets;
+
+        if (block->size() == BinaryTrianglesPerBlock)
+        {
+          publishBlock();
+          block = nullptr;
+        }
+      }
+
+      if (block != nullptr)
+      {
+        publishBlock();
+      }
+    }
+    else
+    {
+      //
+      // foreach triangle
+      //
+      //    REAL32[3] – Normal vector
+      //    REAL32[3] – Vertex 1
+      //    REAL32[3] – Vertex 2
+      //    REAL32[3] – Vertex 3
+      //    UINT16 – Attribute byte count
+      //
+      for (SizeValueType first = 0; first < numberOfFacets; first += BinaryTrianglesPerBlock)
+      {
+        const SizeValueType numberOfFacetsInBlock = std::min(numberOfFacets - first, BinaryTrianglesPerBlock);
+
+        const char *             records = this->ReadRecordsFromBinary(numberOfFacetsInBlock);
+        std::vector<FacetType> * block = acquireBlock();
+        if (block == nullptr)
+        {
+          break;
+        }
+
+        block->resize(numberOfFacetsInBlock);
+        for (SizeValueType t = 0; t < numberOfFacetsInBlock; ++t)
+        {
+          const char * record = records + BinaryTriangleRecordSize * t;
+          FacetType &  facet = (*block)[t];
+          std::memcpy(facet.m_Normal, record, sizeof(facet.m_Normal));
+          std::memcpy(facet.m_Vertices, record + sizeof(facet.m_Normal), sizeof(facet.m_Vertices));
+          std::memcpy(&facet.m_AttributeByteCount, record + 48, sizeof(facet.m_AttributeByteCount));
+          ByteSwapper<float>::SwapRangeFromSystemToLittleEndian(facet.m_Normal, 3);
+          ByteSwapper<float>::SwapRangeFromSystemToLittleEndian(facet.m_Vertices, 9);
+          ByteSwapper<uint16_t>::SwapFromSystemToLittleEndian(&facet.m_AttributeByteCount);
+        }
+
+        publishBlock();
+      }
+    }
+  }
+  catch (...)
+  {
+    readerError = std::current_exception();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+  }
+  condition.notify_all();
+  writer.join();
+
+  this->CloseInputStream();
+
+  //
+  // Footer of the ASCII output, or number of facets of the binary output
+  //
+  bool succeeded = !readerError && !writerError;
+  if (succeeded && outputFileType == IOFileEnum::ASCII)
+  {
+    constexpr char footer[] = "endsolid\n";
+    this->WriteToOutput(footer, sizeof(footer) - 1);
+  }
+  this->FlushOutputChunk();
+
+  if (succeeded && inputFileIsASCII && outputFileType != IOFileEnum::ASCII)
+  {
+    succeeded = numberOfFacets <= std::numeric_limits<uint32_t>::max();
+
+    auto numberOfTriangles = static_cast<int32_t>(numberOfFacets);
+    ByteSwapper<int32_t>::SwapFromSystemToLittleEndian(&numberOfTriangles);
+
+    if (this->m_OutputBuffer != nullptr)
+    {
+      std::memcpy(this->m_OutputBuffer->data() + 80, &numberOfTriangles, sizeof(numberOfTriangles));
+    }
+    else
+    {
+      this->m_OutputStream.seekp(80);
+      this->m_OutputStream.write(reinterpret_cast<const char *>(&numberOfTriangles), sizeof(numberOfTriangles));
+    }
+  }
+
+  if (this->m_OutputBuffer == nullptr)
+  {
+    this->m_OutputStream.close();
+    succeeded = succeeded && !this->m_OutputStream.fail();
+    this->m_OutputStream.clear();
+  }
+
+  if (readerError)
+  {
+    std::rethrow_exception(readerError);
+  }
+  if (writerError)
+  {
+    std::rethrow_exception(writerError);
+  }
+  if (!succeeded)
+  {
+    itkExceptionMacro("Error writing file\n"
+                      "outputFilename= "
+                      << outputFileName);
+  }
+
+  return numberOfFacets;
+}
+
+
+void
+STLMeshIO ::WriteFacets(const FacetType * facets, SizeValueType numberOfFacets, IOFileEnum fileType)
+{
+  AsciiFacetFormatter formatter;
+
+  for (SizeValueType t = 0; t < numberOfFacets; ++t)
+  {
+    const FacetType & facet = facets[t];
+
+    if (fileType == IOFileEnum::ASCII)
+    {
+      const float * v = facet.m_Vertices;
+
+      const size_t textLength = formatter.Format(facet.m_Normal, v, v + 3, v + 6);
+      this->WriteToOutput(formatter.GetText(), textLength);
+    }
+    else
+    {
+      //
+      // Binary values in STL files are expected to be in little endian
+      // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
+      //
+      float values[12];
+      std::memcpy(values, facet.m_Normal, sizeof(facet.m_Normal));
+      std::memcpy(values + 3, facet.m_Vertices, sizeof(facet.m_Vertices));
+      ByteSwapper<float>::SwapRangeFromSystemToLittleEndian(values, 12);
+
+      uint16_t attributeByteCount = facet.m_AttributeByteCount;
+      ByteSwapper<uint16_t>::SwapFromSystemToLittleEndian(&attributeByteCount);
+
+      char record[BinaryTriangleRecordSize];
+      std::memcpy(record, values, sizeof(values));
+      std::memcpy(record + sizeof(values), &attributeByteCount, sizeof(attributeByteCount));
+      this->WriteToOutput(record, sizeof(record));
+    }
+  }
+}
+
+
+void
+STLMeshIO ::WriteMeshInformation()
+{
+  this->m_CellsWritten = false;
+
+  // Triangles are only appended to binary files that already exist,
+  // others are written from scratch.
+  this->m_Appending = this->m_AppendToFile && this->m_OutputBuffer == nullptr && !this->UseShardedOutput() &&
+                      this->GetFileType() == IOFileEnum::BINARY &&
+                      itksys::SystemTools::FileExists(this->m_FileName, true);
+
+  if (this->m_Appending)
+  {
+    this->OpenOutputForAppending();
+    return;
+  }
+
+  // The memory-mapped file, and the shards, are only created by
+  // WriteCellsAsBinary(), once the number of triangles is known.
+  if (this->UseMemoryMappedOutput() || this->UseShardedOutput())
+  {
+    return;
+  }
+
+  // Use default filetype. The memory buffer is sized for the binary
+  // records of the triangles.
+  if (this->m_OutputBuffer != nullptr)
+  {
+    this->m_OutputBuffer->clear();
+    if (this->GetFileType() == IOFileEnum::BINARY)
+    {
+      this->m_OutputBuffer->reserve(BinaryHeaderSize + BinaryTriangleRecordSize * this->GetNumberOfCells());
+    }
+  }
+  else if (this->GetFileType() == IOFileEnum::ASCII)
+  {
+    this->m_OutputStream.open(this->m_FileName.c_str(), std::ios::out);
+  }
+  else if (this->GetFileType() == IOFileEnum::BINARY)
+  {
+    this->m_OutputStream.open(this->m_FileName.c_str(), std::ios::out | std::ios::binary);
+  }
+
+  if (this->m_OutputBuffer == nullptr && !this->m_OutputStream.is_open())
+  {
+    itkExceptionMacro("Unable to open file\n"
+                      "inputFilename= "
+                      << this->m_FileName);
+    return;
+  }
+
+  this->m_OutputChunk.clear();
+  this->m_OutputChunk.reserve(OutputChunkSize);
+
+  if (this->m_UseBackgroundWriter && this->m_OutputBuffer == nullptr)
+  {
+    this->m_BackgroundWriter = std::make_unique<BackgroundWriter>(this->m_OutputStream);
+  }
+
+  if (this->GetFileType() == IOFileEnum::ASCII)
+  {
+    constexpr char header[] = "solid ascii\n";
+    this->WriteToOutput(header, sizeof(header) - 1);
+  }
+  else if (this->GetFileType() == IOFileEnum::BINARY)
+  {
+    //
+    // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
+    //
+    // UINT8[80] header
+    //
+    char header[80];
+    FormatBinaryHeader(header);
+    this->WriteToOutput(header, sizeof(header));
+  }
+}
+
+
+void
+STLMeshIO ::Write()
+{
+  // All has been done in the WriteCells() method, which MeshFileWriter
+  // skips for meshes without cells: the number of triangles, the end of
+  // an ASCII file, the memory-mapped file and the shards are then only
+  // written for an empty list of cells.
+  if (!this->m_CellsWritten)
+  {
+    this->SetNumberOfCells(0);
+    this->WriteCells(nullptr);
+  }
+
+  // Here we only need to flush the pending output and close the stream.
+  if (this->UseMemoryMappedOutput())
+  {
+    this->FinishMemoryMappedOutput();
+  }
+  else if (!this->UseShardedOutput())
+  {
+    this->FinishOutput();
+  }
+
+  if (this->m_Appending)
+  {
+    this->m_Appending = false;
+    this->PatchNumberOfTriangles();
+  }
+}
+
+
+void
+STLMeshIO ::OpenOutputForAppending()
+{
+  //
+  // Only a well-formed binary file can be extended: its header must
+  // announce exactly as many 50-byte records as the file holds, so
+  // that the new records start right after the last existing one.
+  //
+  std::ifstream existing(this->m_FileName.c_str(), std::ios::in | std::ios::binary);
+
+  char    header[80];
+  int32_t numberOfTriangles = -1;
+  existing.read(header, sizeof(header));
+  existing.read(reinterpret_cast<char *>(&numberOfTriangles), sizeof(numberOfTriangles));
+  ByteSwapper<int32_t>::SwapFromSystemToLittleEndian(&numberOfTriangles);
+
+  const auto fileSize = static_cast<uint64_t>(itksys::SystemTools::FileLength(this->m_FileName));
+  if (!existing || numberOfTriangles < 0 ||
+      fileSize != BinaryHeaderSize + BinaryTriangleRecordSize * static_cast<uint64_t>(numberOfTriangles))
+  {
+    this->m_Appending = false;
+    itkExceptionMacro("Unable to append to file: it is not a complete binary STL file\n"
+                      "outputFilename= "
+                      << this->m_FileName);
+  }
+  existing.close();
+
+  this->m_NumberOfExistingTriangles = static_cast<SizeValueType>(numberOfTriangles);
+
+  this->m_OutputStream.open(this->m_FileName.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+
+  if (!this->m_OutputStream.is_open())
+  {
+    this->m_Appending = false;
+    itkExceptionMacro("Unable to open file\n"
+                      "outputFilename= "
+                      << this->m_FileName);
+  }
+
+  this->m_OutputStream.seekp(0, std::ios::end);
+
+  this->m_OutputChunk.clear();
+  this->m_OutputChunk.reserve(OutputChunkSize);
+
+  if (this->m_UseBackgroundWriter)
+  {
+    this->m_BackgroundWriter = std::make_unique<BackgroundWriter>(this->m_OutputStream);
+  }
+}
+
+
+void
+STLMeshIO ::PatchNumberOfTriangles()
+{
+  //
+  // UINT32 -- Number of Triangles, right after the 80-byte header
+  //
+  auto numberOfTriangles = static_cast<int32_t>(this->m_NumberOfExistingTriangles + this->m_NumberOfAppendedTriangles);
+  ByteSwapper<int32_t>::SwapFromSystemToLittleEndian(&numberOfTriangles);
+
+  std::fstream file(this->m_FileName.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+  file.seekp(80);
+  file.write(reinterpret_cast<const char *>(&numberOfTriangles), sizeof(numberOfTriangles));
+  file.close();
+
+  if (file.fail())
+  {
+    itkExceptionMacro("Error writing file\n"
+                      "outputFilename= "
+                      << this->m_FileName);
+  }
+}
+
+
+void
+STLMeshIO ::WriteToOutput(const char * data, size_t size)
+{
+  if (this->m_OutputBuffer != nullptr)
+  {
+    this->m_OutputBuffer->insert(this->m_OutputBuffer->end(), data, data + size);
+    return;
+  }
+
+  if (this->m_OutputChunk.size() + size > OutputChunkSize)
+  {
+    this->FlushOutputChunk();
+  }
+
+  this->m_OutputChunk.insert(this->m_OutputChunk.end(), data, data + size);
+}
+
+
+void
+STLMeshIO ::FlushOutputChunk()
+{
+  if (this->m_OutputChunk.empty())
+  {
+    return;
+  }
+
+  if (this->m_BackgroundWriter)
+  {
+    this->m_BackgroundWriter->Push(this->m_OutputChunk);
+  }
+  else
+  {
+    this->m_OutputStream.write(this->m_OutputChunk.data(), this->m_OutputChunk.size());
+    this->m_OutputChunk.clear();
+  }
+}
 
 
 void
-STLMeshIO ::ReadMeshInternalFromBinary()
+STLMeshIO ::FinishOutput()
 {
-  //
-  // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
-  //
-  // UINT8[80] header
-  //
-  char header[80];
-  this->m_InputStream.read(header, 80);
+  if (this->m_OutputBuffer != nullptr)
+  {
+    return;
+  }
 
-  header[79] = '\0'; // insert string terminator
+  this->FlushOutputChunk();
+
+  bool succeeded = true;
+
+  if (this->m_BackgroundWriter)
+  {
+    succeeded = this->m_BackgroundWriter->Finish();
+    this->m_BackgroundWriter.reset();
+  }
+
+  this->m_OutputStream.close();
+
+  if (!succeeded || this->m_OutputStream.fail())
+  {
+    this->m_OutputStream.clear();
+    itkExceptionMacro("Error writing file\n"
+                      "outputFilename= "
+                      << this->m_FileName);
+  }
+}
+
+void
+STLMeshIO ::WritePoints(void * buffer)
+{
+
+  const IOComponentEnum pointValueType = this->GetPointComponentType();
+
+  switch (pointValueType)
+  {
+    case IOComponentEnum::UCHAR:
+    {
+      using CoordType = unsigned char;
+      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
+      break;
+    }
+    case IOComponentEnum::CHAR:
+    {
+      using CoordType = char;
+      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
+      break;
+    }
+    case IOComponentEnum::USHORT:
+    {
+      using CoordType = unsigned short;
+      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
+      break;
+    }
+    case IOComponentEnum::SHORT:
+    {
+      using CoordType = short;
+      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
+      break;
+    }
+    case IOComponentEnum::UINT:
+    {
+      using CoordType = unsigned int;
+      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
+      break;
+    }
+    case IOComponentEnum::INT:
+    {
+      using CoordType = int;
+      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
+      break;
+    }
+    case IOComponentEnum::ULONG:
+    {
+      using CoordType = unsigned long;
+      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
+      break;
+    }
+    case IOComponentEnum::LONG:
+    {
+      using CoordType = long;
+      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
+      break;
+    }
+    case IOComponentEnum::ULONGLONG:
+    {
+      using CoordType = unsigned long long;
+      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
+      break;
+    }
+    case IOComponentEnum::LONGLONG:
+    {
+      using CoordType = long long;
+      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
+      break;
+    }
+    case IOComponentEnum::FLOAT:
+    {
+      using CoordType = float;
+      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
+      break;
+    }
+    case IOComponentEnum::DOUBLE:
+    {
+      using CoordType = double;
+      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
+      break;
+    }
+    case IOComponentEnum::LDOUBLE:
+    {
+      using CoordType = long double;
+      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
+      break;
+    }
+    default:
+      itkExceptionMacro(<< "Unknonwn point component type");
+  }
+}
+
+
+void
+STLMeshIO ::WriteCells(void * buffer)
+{
+  this->m_CellsWritten = true;
+
+  if (this->GetFileType() == IOFileEnum::BINARY)
+  {
+    this->WriteCellsAsBinary(buffer);
+  }
+  else
+  {
+    this->WriteCellsAsAscii(buffer);
+  }
+}
+
+void
+STLMeshIO ::WriteTriangles(void * buffer, IOComponentEnum componentType)
+{
+  this->m_CellsWritten = true;
+
+  switch (componentType)
+  {
+    case IOComponentEnum::UINT:
+      this->WriteTrianglesTyped(reinterpret_cast<const unsigned int *>(buffer));
+      break;
+    case IOComponentEnum::ULONG:
+      this->WriteTrianglesTyped(reinterpret_cast<const unsigned long *>(buffer));
+      break;
+    case IOComponentEnum::ULONGLONG:
+      this->WriteTrianglesTyped(reinterpret_cast<const unsigned long long *>(buffer));
+      break;
+    default:
+      itkExceptionMacro("Unsupported triangle component type: " << componentType);
+  }
+}
+
+
+template <typename TPointId>
+void
+STLMeshIO ::WriteTrianglesTyped(const TPointId * buffer)
+{
+  // The triangles are encoded from the buffer of the caller: every cell is
+  // a triangle, and no polygon is split.
+  this->m_CellOffsets.clear();
+  this->m_FirstTriangles.clear();
+
+  const PackedTriangleView<TPointId> triangles(buffer);
+  if (this->GetFileType() == IOFileEnum::BINARY)
+  {
+    this->WriteTrianglesAsBinary(triangles, this->GetNumberOfCells());
+  }
+  else
+  {
+    this->WriteTrianglesAsAscii(triangles);
+  }
+}
+
+SizeValueType
+STLMeshIO ::IndexCellsForWriting(const IdentifierType * cellsBuffer)
+{
+  const SizeValueType numberOfCells = this->GetNumberOfCells();
 
+  this->m_CellOffsets.clear();
+  this->m_FirstTriangles.clear();
 
-  this->m_LatestPointId = NumericTraits<IdentifierType>::Zero;
+  if (this->m_TriangulatePolygons)
+  {
+    this->m_CellOffsets.resize(numberOfCells);
+  }
 
   //
-  // UINT32 -- Number of Triangles
+  // Cells have a variable size in the buffer: cell type, number of points
+  // and point Ids. Their offsets can only be found by walking the buffer.
   //
-  int32_t numberOfTriangles;
-  this->m_InputStream.read(reinterpret_cast<char *>(&numberOfTriangles), sizeof(numberOfTriangles));
+  SizeValueType index = 0;
+
+  for (SizeValueType cellId = 0; cellId < numberOfCells; ++cellId)
+  {
+    const auto cellType = static_cast<CellGeometryEnum>(cellsBuffer[index]);
+    const auto numberOfVerticesInCell = static_cast<SizeValueType>(cellsBuffer[index + 1]);
+
+    const bool isTriangle = (cellType == CellGeometryEnum::TRIANGLE_CELL) ||
+                            (cellType == CellGeometryEnum::POLYGON_CELL && numberOfVerticesInCell == 3);
+
+    const bool isPolygon = (cellType == CellGeometryEnum::QUADRILATERAL_CELL && numberOfVerticesInCell == 4) ||
+                           (cellType == CellGeometryEnum::POLYGON_CELL && numberOfVerticesInCell >= 3);
+
+    if (!isTriangle && !(this->m_TriangulatePolygons && isPolygon))
+    {
+      itkExceptionMacro("Found Non-Triangular Cell.");
+    }
+
+    if (this->m_TriangulatePolygons)
+    {
+      this->m_CellOffsets[cellId] = index;
+    }
+
+    index += 2 + numberOfVerticesInCell;
+  }
+
+  if (!this->m_TriangulatePolygons)
+  {
+    return numberOfCells;
+  }
 
   //
-  // Binary values in STL files are expected to be in little endian
-  // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
+  // A polygon of n points is split into n - 2 triangles. The index of the
+  // first triangle of every cell is an exclusive prefix sum of these
+  // counts: the sums of consecutive blocks of cells are computed in
+  // parallel, scanned, and then expanded in parallel within each block.
   //
-  ByteSwapper<int32_t>::SwapFromSystemToLittleEndian(&numberOfTriangles);
+  constexpr SizeValueType cellsPerWorkItem = 1 << 16;
 
-  this->SetNumberOfCells(numberOfTriangles);
+  const SizeValueType numberOfWorkItems = (numberOfCells + cellsPerWorkItem - 1) / cellsPerWorkItem;
+
+  const auto numberOfTrianglesInCell = [this, cellsBuffer](SizeValueType cellId) {
+    return static_cast<SizeValueType>(cellsBuffer[this->m_CellOffsets[cellId] + 1]) - 2;
+  };
+
+  std::vector<SizeValueType> blockFirstTriangles(numberOfWorkItems + 1, 0);
+
+  MultiThreaderBase::Pointer multiThreader = MultiThreaderBase::New();
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfWorkItems,
+    [&](SizeValueType workItem) {
+      const SizeValueType first = workItem * cellsPerWorkItem;
+      const SizeValueType last = std::min(first + cellsPerWorkItem, numberOfCells);
+
+      SizeValueType numberOfTriangles = 0;
+      for (SizeValueType cellId = first; cellId < last; ++cellId)
+      {
+        numberOfTriangles += numberOfTrianglesInCell(cellId);
+      }
+      blockFirstTriangles[workItem + 1] = numberOfTriangles;
+    },
+    nullptr);
+
+  for (SizeValueType workItem = 0; workItem < numberOfWorkItems; ++workItem)
+  {
+    blockFirstTriangles[workItem + 1] += blockFirstTriangles[workItem];
+  }
+
+  this->m_FirstTriangles.resize(numberOfCells);
+
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfWorkItems,
+    [&](SizeValueType workItem) {
+      const SizeValueType first = workItem * cellsPerWorkItem;
+      const SizeValueType last = std::min(first + cellsPerWorkItem, numberOfCells);
+
+      SizeValueType firstTriangle = blockFirstTriangles[workItem];
+      for (SizeValueType cellId = first; cellId < last; ++cellId)
+      {
+        this->m_FirstTriangles[cellId] = firstTriangle;
+        firstTriangle += numberOfTrianglesInCell(cellId);
+      }
+    },
+    nullptr);
+
+  return blockFirstTriangles[numberOfWorkItems];
+}
+
+
+void
+STLMeshIO ::WriteCellsAsBinary(void * buffer)
+{
+  const auto * cellsBuffer = reinterpret_cast<const IdentifierType *>(buffer);
+
+  const SizeValueType numberOfTriangles = this->IndexCellsForWriting(cellsBuffer);
+
+  this->WriteTrianglesAsBinary(CellBufferView(cellsBuffer, this->m_CellOffsets, this->m_FirstTriangles),
+                               numberOfTriangles);
+}
+
+
+template <typename TCellView>
+void
+STLMeshIO ::WriteTrianglesAsBinary(const TCellView & cells, SizeValueType numberOfTriangles)
+{
+  const SizeValueType numberOfPolygons = this->GetNumberOfCells();
 
   //
-  // foreach triangle
+  // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
   //
-  NormalType normal;
-  PointType  p0;
-  PointType  p1;
-  PointType  p2;
-  int16_t    bytecount;
+  // UINT32 -- Number of Triangles
+  //
+  if (this->UseShardedOutput())
+  {
+    this->WriteCellsAsShards(cells, numberOfTriangles);
+    return;
+  }
 
-  while (numberOfTriangles--)
+  if (numberOfTriangles > static_cast<SizeValueType>(std::numeric_limits<int32_t>::max()))
   {
-    //
-    //    REAL32[3] – Normal vector
-    //    REAL32[3] – Vertex 1
-    //    REAL32[3] – Vertex 2
-    //    REAL32[3] – Vertex 3
-    //    UINT16 – Attribute byte count
-    //
-    this->m_PointInTriangleCounter = 0;
+    itkExceptionMacro("Too many triangles for a binary STL file\n"
+                      "outputFilename= "
+                      << this->m_FileName);
+  }
 
-    this->ReadNormalAsBinary(normal);
-    this->ReadPointAsBinary(p0);
-    this->ReadPointAsBinary(p1);
-    this->ReadPointAsBinary(p2);
-    this->ReadInt16AsBinary(bytecount);
+  if (this->UseMemoryMappedOutput())
+  {
+    this->WriteCellsAsMemoryMappedBinary(cells, numberOfTriangles);
+    return;
+  }
 
-    this->m_CellsVector.push_back(this->m_TrianglePointIds);
+  //
+  // When appending, the number of triangles in the existing header is
+  // patched by Write(), once all the new records are on disk.
+  //
+  if (this->m_Appending)
+  {
+    if (this->m_NumberOfExistingTriangles + numberOfTriangles >
+        static_cast<SizeValueType>(std::numeric_limits<int32_t>::max()))
+    {
+      itkExceptionMacro("Too many triangles to append to file\n"
+                        "outputFilename= "
+                        << this->m_FileName);
+    }
+    this->m_NumberOfAppendedTriangles = numberOfTriangles;
+  }
+  else
+  {
+    this->WriteInt32AsBinary(static_cast<int32_t>(numberOfTriangles));
   }
 
-  this->SetNumberOfPoints(this->m_PointsMap.size());
+  char record[BinaryTriangleRecordSize];
+
+  for (SizeValueType polygonItr = 0; polygonItr < numberOfPolygons; polygonItr++)
+  {
+    const SizeValueType numberOfVerticesInCell = cells.GetNumberOfPoints(polygonItr);
+    const auto *        pointIds = cells.GetPointIds(polygonItr);
+
+    // Polygons are split into a fan of triangles around their first point
+    for (SizeValueType j = 1; j + 1 < numberOfVerticesInCell; ++j)
+    {
+      this->WriteTriangleAsBinary(
+        m_Points[pointIds[0]], m_Points[pointIds[j]], m_Points[pointIds[j + 1]], record);
+      this->WriteToOutput(record, BinaryTriangleRecordSize);
+    }
+  }
 
   //
-  // The factor 5 accounts for five integers
-  //  1. cell type id
-  //  2. number of points in cell
-  //  3. point id of point 0
-  //  4. point id of point 1
-  //  5. point id of point 2
-  //
-  this->SetCellBufferSize(5 * this->m_CellsVector.size());
+  // There is no ending section when doing BINARY
+  //
 }
 
 
-void
-STLMeshIO ::ReadPoints(void * buffer)
+bool
+STLMeshIO ::UseMemoryMappedOutput() const
 {
-  //
-  // The Point and Cell data were read in the ReadMeshInformation() method.
-  // Here, we can focus on packaging the point data into the return buffer.
-  //
-  PointsMapType::const_iterator pointItr = this->m_PointsMap.begin();
-  PointsMapType::const_iterator pointEnd = this->m_PointsMap.end();
+#if !defined(_WIN32)
+  return this->m_UseMemoryMappedWriter && this->m_OutputBuffer == nullptr && !this->UseShardedOutput() &&
+         this->GetFileType() == IOFileEnum::BINARY && !this->m_Appending;
+#else
+  return false;
+#endif
+}
 
-  auto * pointsBuffer = reinterpret_cast<float *>(buffer);
 
-  while (pointItr != pointEnd)
-  {
-    // Get the reference to that PointType object.
-    const PointType & point = pointItr->first;
+bool
+STLMeshIO ::UseShardedOutput() const
+{
+  return this->m_NumberOfShards > 1 && this->m_OutputBuffer == nullptr && this->GetFileType() == IOFileEnum::BINARY;
+}
 
-    // Get the location in the buffer where the point should be stored
-    float * pointCoordinates = pointsBuffer + 3 * pointItr->second;
 
-    //
-    // Store the Point coordinates in the buffer.
-    //
-    *pointCoordinates++ = point[0];
-    *pointCoordinates++ = point[1];
-    *pointCoordinates++ = point[2];
+std::string
+STLMeshIO ::GetShardFileName(unsigned int shard) const
+{
+  return this->GetCompanionFileName(("." + std::to_string(shard) + ".stl").c_str());
+}
 
-    ++pointItr;
-  }
+
+std::string
+STLMeshIO ::GetShardManifestFileName() const
+{
+  return this->GetCompanionFileName(".stlshards");
 }
 
 
+template <typename TCellView>
 void
-STLMeshIO ::ReadCells(void * buffer)
+STLMeshIO ::WriteCellsAsShards(const TCellView & cells, SizeValueType numberOfTriangles)
 {
   //
-  // The Point and Cell data were read in the ReadMeshInformation() method.
-  // Here, we can focus on packaging the cell data into the return buffer.
+  // Point Ids of every triangle, in the order of the cells: the index of
+  // the first triangle of every cell is known from the view of the cells.
   //
-  CellsVectorType::const_iterator cellItr = this->m_CellsVector.begin();
-  CellsVectorType::const_iterator cellEnd = this->m_CellsVector.end();
+  const SizeValueType numberOfCells = this->GetNumberOfCells();
 
-  using CellIDType = unsigned int;
-  auto * cellPointIds = reinterpret_cast<CellIDType *>(buffer);
+  std::vector<std::array<IdentifierType, 3>> triangles(numberOfTriangles);
 
-  constexpr unsigned int numberOfPointsInCell = 3;
+  constexpr SizeValueType cellsPerWorkItem = 1 << 14;
 
-  while (cellItr != cellEnd)
-  {
+  const SizeValueType numberOfWorkItems = (numberOfCells + cellsPerWorkItem - 1) / cellsPerWorkItem;
 
-    *cellPointIds++ = static_cast<CellIDType>(CellGeometryEnum::TRIANGLE_CELL);
-    *cellPointIds++ = numberOfPointsInCell;
+  MultiThreaderBase::Pointer multiThreader = MultiThreaderBase::New();
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfWorkItems,
+    [&](SizeValueType workItem) {
+      const SizeValueType first = workItem * cellsPerWorkItem;
+      const SizeValueType last = std::min(first + cellsPerWorkItem, numberOfCells);
 
-    //
-    // Store the Point Ids for this cell, in the buffer.
-    //
-    *cellPointIds++ = cellItr->p0;
-    *cellPointIds++ = cellItr->p1;
-    *cellPointIds++ = cellItr->p2;
+      for (SizeValueType cellId = first; cellId < last; ++cellId)
+      {
+        const SizeValueType firstTriangle = cells.GetFirstTriangle(cellId);
+        const SizeValueType numberOfVerticesInCell = cells.GetNumberOfPoints(cellId);
+        const auto *        pointIds = cells.GetPointIds(cellId);
+
+        for (SizeValueType j = 1; j + 1 < numberOfVerticesInCell; ++j)
+        {
+          triangles[firstTriangle + j - 1] = { { static_cast<IdentifierType>(pointIds[0]),
+                                                 static_cast<IdentifierType>(pointIds[j]),
+                                                 static_cast<IdentifierType>(pointIds[j + 1]) } };
+        }
+      }
+    },
+    nullptr);
 
-    ++cellItr;
-  }
-}
+  //
+  // Shard k holds the triangles [shardBegin(k), shardBegin(k + 1)) of the
+  // order: the order of the cells, or the order of the centroids along
+  // ShardAxis. In the latter case, the order is only partitioned at the
+  // boundaries of the shards, and then restored within each shard.
+  //
+  const unsigned int numberOfShards = this->m_NumberOfShards;
 
+  const auto shardBegin = [numberOfTriangles, numberOfShards](SizeValueType shard) {
+    return numberOfTriangles * shard / numberOfShards;
+  };
 
-void
-STLMeshIO ::WriteMeshInformation()
-{
+  std::vector<SizeValueType> order(numberOfTriangles);
+  std::iota(order.begin(), order.end(), SizeValueType{ 0 });
 
-  // Use default filetype
-  if (this->GetFileType() == IOFileEnum::ASCII)
-  {
-    this->m_OutputStream.open(this->m_FileName.c_str(), std::ios::out);
-  }
-  else if (this->GetFileType() == IOFileEnum::BINARY)
+  if (this->m_ShardAxis >= 0)
   {
-    this->m_OutputStream.open(this->m_FileName.c_str(), std::ios::out | std::ios::binary);
-  }
+    const auto axis = static_cast<unsigned int>(this->m_ShardAxis);
+
+    std::vector<float> centroids(numberOfTriangles);
+    multiThreader->ParallelizeArray(
+      0,
+      numberOfTriangles,
+      [&](SizeValueType t) {
+        const std::array<IdentifierType, 3> & triangle = triangles[t];
+        centroids[t] = this->m_Points[triangle[0]][axis] + this->m_Points[triangle[1]][axis] +
+                       this->m_Points[triangle[2]][axis];
+      },
+      nullptr);
+
+    const auto centroidLess = [&centroids](SizeValueType a, SizeValueType b) {
+      return centroids[a] < centroids[b] || (centroids[a] == centroids[b] && a < b);
+    };
+
+    for (unsigned int shard = 1; shard < numberOfShards; ++shard)
+    {
+      std::nth_element(
+        order.begin() + shardBegin(shard - 1), order.begin() + shardBegin(shard), order.end(), centroidLess);
+    }
 
-  if (!this->m_OutputStream.is_open())
-  {
-    itkExceptionMacro("Unable to open file\n"
-                      "inputFilename= "
-                      << this->m_FileName);
-    return;
+    multiThreader->ParallelizeArray(
+      0,
+      numberOfShards,
+      [&](SizeValueType shard) {
+        std::sort(order.begin() + shardBegin(shard), order.begin() + shardBegin(shard + 1));
+      },
+      nullptr);
   }
 
-  if (this->GetFileType() == IOFileEnum::ASCII)
+  for (unsigned int shard = 0; shard < numberOfShards; ++shard)
   {
-    this->m_OutputStream << "solid ascii" << std::endl;
-  }
-  else if (this->GetFileType() == IOFileEnum::BINARY)
-  {
-    //
-    // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
-    //
-    // UINT8[80] header
-    //
-    this->m_OutputStream << std::setfill(' ') << std::setw(80) << "binary STL generated from ITK";
+    if (shardBegin(shard + 1) - shardBegin(shard) > static_cast<SizeValueType>(std::numeric_limits<int32_t>::max()))
+    {
+      itkExceptionMacro("Too many triangles for a binary STL file\n"
+                        "outputFilename= "
+                        << this->GetShardFileName(shard));
+    }
   }
-}
 
+  //
+  // Every work unit writes whole shards, and the bounds of their triangles.
+  //
+  std::vector<std::array<float, 6>> shardBounds(numberOfShards);
+  std::vector<char>                 shardFailed(numberOfShards, 0);
+
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfShards,
+    [&](SizeValueType shard) {
+      const SizeValueType first = shardBegin(shard);
+      const SizeValueType last = shardBegin(shard + 1);
+
+      std::array<float, 6> & bounds = shardBounds[shard];
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        bounds[2 * i] = NumericTraits<float>::max();
+        bounds[2 * i + 1] = NumericTraits<float>::NonpositiveMin();
+      }
 
-void
-STLMeshIO ::Write()
-{
-  // All has been done in the WriteCells() method.
+      std::ofstream shardStream(this->GetShardFileName(shard).c_str(), std::ios::out | std::ios::binary);
 
-  // Here we only need to close the output stream.
-  m_OutputStream.close();
-}
+      //
+      // UINT8[80] header
+      // UINT32 -- Number of Triangles
+      //
+      std::vector<char> chunk(BinaryHeaderSize);
+      chunk.reserve(OutputChunkSize);
+      FormatBinaryHeader(chunk.data());
 
-void
-STLMeshIO ::WritePoints(void * buffer)
-{
+      auto count = static_cast<int32_t>(last - first);
+      ByteSwapper<int32_t>::SwapFromSystemToLittleEndian(&count);
+      std::memcpy(chunk.data() + 80, &count, sizeof(count));
 
-  const IOComponentEnum pointValueType = this->GetPointComponentType();
+      char record[BinaryTriangleRecordSize];
+      for (SizeValueType t = first; t < last; ++t)
+      {
+        const std::array<IdentifierType, 3> & triangle = triangles[order[t]];
+
+        for (const IdentifierType pointId : triangle)
+        {
+          const PointType & point = this->m_Points[pointId];
+          for (unsigned int i = 0; i < 3; ++i)
+          {
+            bounds[2 * i] = std::min(bounds[2 * i], float{ point[i] });
+            bounds[2 * i + 1] = std::max(bounds[2 * i + 1], float{ point[i] });
+          }
+        }
+
+        WriteTriangleAsBinary(
+          this->m_Points[triangle[0]], this->m_Points[triangle[1]], this->m_Points[triangle[2]], record);
+
+        if (chunk.size() + BinaryTriangleRecordSize > OutputChunkSize)
+        {
+          shardStream.write(chunk.data(), chunk.size());
+          chunk.clear();
+        }
+        chunk.insert(chunk.end(), record, record + BinaryTriangleRecordSize);
+      }
 
-  switch (pointValueType)
+      shardStream.write(chunk.data(), chunk.size());
+      shardStream.close();
+      shardFailed[shard] = shardStream.fail();
+    },
+    nullptr);
+
+  for (unsigned int shard = 0; shard < numberOfShards; ++shard)
   {
-    case IOComponentEnum::UCHAR:
-    {
-      using CoordType = unsigned char;
-      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
-      break;
-    }
-    case IOComponentEnum::CHAR:
-    {
-      using CoordType = char;
-      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
-      break;
-    }
-    case IOComponentEnum::USHORT:
-    {
-      using CoordType = unsigned short;
-      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
-      break;
-    }
-    case IOComponentEnum::SHORT:
-    {
-      using CoordType = short;
-      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
-      break;
-    }
-    case IOComponentEnum::UINT:
-    {
-      using CoordType = unsigned int;
-      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
-      break;
-    }
-    case IOComponentEnum::INT:
-    {
-      using CoordType = int;
-      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
-      break;
-    }
-    case IOComponentEnum::ULONG:
+    if (shardFailed[shard])
     {
-      using CoordType = unsigned long;
-      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
-      break;
-    }
-    case IOComponentEnum::LONG:
-    {
-      using CoordType = long;
-      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
-      break;
-    }
-    case IOComponentEnum::ULONGLONG:
-    {
-      using CoordType = unsigned long long;
-      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
-      break;
-    }
-    case IOComponentEnum::LONGLONG:
-    {
-      using CoordType = long long;
-      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
-      break;
-    }
-    case IOComponentEnum::FLOAT:
-    {
-      using CoordType = float;
-      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
-      break;
-    }
-    case IOComponentEnum::DOUBLE:
-    {
-      using CoordType = double;
-      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
-      break;
+      itkExceptionMacro("Error writing file\n"
+                        "outputFilename= "
+                        << this->GetShardFileName(shard));
     }
-    case IOComponentEnum::LDOUBLE:
+  }
+
+  //
+  // The manifest names the shards relative to its own directory, and is
+  // formatted in the classic locale whatever the one of the process.
+  //
+  std::ofstream manifest(this->GetShardManifestFileName().c_str(), std::ios::out);
+  manifest.imbue(std::locale::classic());
+
+  manifest << "STLShards 1\n";
+  manifest << "shards " << numberOfShards << '\n';
+  manifest << "axis " << (this->m_ShardAxis < 0 ? "none" : std::string(1, "xyz"[this->m_ShardAxis])) << '\n';
+  manifest << "triangles " << numberOfTriangles << '\n';
+  manifest << "# shard fileName numberOfTriangles xmin xmax ymin ymax zmin zmax\n";
+  manifest << std::setprecision(9);
+  for (unsigned int shard = 0; shard < numberOfShards; ++shard)
+  {
+    manifest << "shard " << shard << ' ' << itksys::SystemTools::GetFilenameName(this->GetShardFileName(shard)) << ' '
+             << shardBegin(shard + 1) - shardBegin(shard);
+    for (const float bound : shardBounds[shard])
     {
-      using CoordType = long double;
-      this->WritePointsTyped<CoordType>(reinterpret_cast<CoordType *>(buffer));
-      break;
+      manifest << ' ' << bound;
     }
-    default:
-      itkExceptionMacro(<< "Unknonwn point component type");
+    manifest << '\n';
+  }
+
+  manifest.close();
+  if (manifest.fail())
+  {
+    itkExceptionMacro("Error writing file\n"
+                      "outputFilename= "
+                      << this->GetShardManifestFileName());
   }
 }
 
 
+template <typename TCellView>
 void
-STLMeshIO ::WriteCells(void * buffer)
+STLMeshIO ::WriteCellsAsMemoryMappedBinary(const TCellView & cells, SizeValueType numberOfTriangles)
 {
-  if (this->GetFileType() == IOFileEnum::BINARY)
+#if !defined(_WIN32)
+  const SizeValueType fileSize = BinaryHeaderSize + BinaryTriangleRecordSize * numberOfTriangles;
+
+  // A write that failed before Write() leaves its mapping behind.
+  this->ReleaseMemoryMappedOutput();
+
+  this->m_OutputFileDescriptor = ::open(this->m_FileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+  if (this->m_OutputFileDescriptor < 0)
   {
-    this->WriteCellsAsBinary(buffer);
+    itkExceptionMacro("Unable to open file\n"
+                      "outputFilename= "
+                      << this->m_FileName);
   }
-  else
+
+  //
+  // Give the file its final size, and reserve its blocks where supported
+  // so that writing through the mapping does not fail for lack of space.
+  //
+  bool allocated = ::ftruncate(this->m_OutputFileDescriptor, static_cast<off_t>(fileSize)) == 0;
+#  if defined(__linux__)
+  if (allocated)
   {
-    this->WriteCellsAsAscii(buffer);
+    const int status = ::posix_fallocate(this->m_OutputFileDescriptor, 0, static_cast<off_t>(fileSize));
+    allocated = status == 0 || status == EINVAL || status == EOPNOTSUPP;
   }
-}
-
-void
-STLMeshIO ::WriteCellsAsBinary(void * buffer)
-{
-
-  const IdentifierType numberOfPolygons = this->GetNumberOfCells();
+#  endif
 
-  const auto * cellsBuffer = reinterpret_cast<const IdentifierType *>(buffer);
+  void * mapping = MAP_FAILED;
+  if (allocated)
+  {
+    mapping = ::mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, this->m_OutputFileDescriptor, 0);
+  }
 
-  SizeValueType index = 0;
+  if (mapping == MAP_FAILED)
+  {
+    ::close(this->m_OutputFileDescriptor);
+    this->m_OutputFileDescriptor = -1;
+    itkExceptionMacro("Unable to allocate and map file\n"
+                      "outputFilename= "
+                      << this->m_FileName);
+  }
 
-  NormalType normal;
+  this->m_OutputMapping = static_cast<char *>(mapping);
+  this->m_OutputMappingSize = fileSize;
 
   //
   // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
   //
+  // UINT8[80] header
   // UINT32 -- Number of Triangles
   //
-  int32_t numberOfTriangles = 0;
+  FormatBinaryHeader(this->m_OutputMapping);
 
-  SizeValueType index2 = 0;
+  auto count = static_cast<int32_t>(numberOfTriangles);
+  ByteSwapper<int32_t>::SwapFromSystemToLittleEndian(&count);
+  std::memcpy(this->m_OutputMapping + 80, &count, sizeof(count));
 
-  for (SizeValueType polygonItr = 0; polygonItr < numberOfPolygons; polygonItr++)
+  //
+  // The index of the first triangle of every cell in the file is known
+  // from the view of the cells. Hence the records can be filled in
+  // parallel, each one at its own offset of the file.
+  //
+  const SizeValueType numberOfCells = this->GetNumberOfCells();
+
+  constexpr SizeValueType cellsPerWorkItem = 1 << 14;
+
+  const SizeValueType numberOfWorkItems = (numberOfCells + cellsPerWorkItem - 1) / cellsPerWorkItem;
+
+  MultiThreaderBase::Pointer multiThreader = MultiThreaderBase::New();
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfWorkItems,
+    [&](SizeValueType workItem) {
+      const SizeValueType first = workItem * cellsPerWorkItem;
+      const SizeValueType last = std::min(first + cellsPerWorkItem, numberOfCells);
+
+      for (SizeValueType cellId = first; cellId < last; ++cellId)
+      {
+        const SizeValueType numberOfVerticesInCell = cells.GetNumberOfPoints(cellId);
+        const auto *        pointIds = cells.GetPointIds(cellId);
+
+        char * record =
+          this->m_OutputMapping + BinaryHeaderSize + BinaryTriangleRecordSize * cells.GetFirstTriangle(cellId);
+
+        for (SizeValueType j = 1; j + 1 < numberOfVerticesInCell; ++j, record += BinaryTriangleRecordSize)
+        {
+          this->WriteTriangleAsBinary(
+            this->m_Points[pointIds[0]], this->m_Points[pointIds[j]], this->m_Points[pointIds[j + 1]], record);
+        }
+      }
+    },
+    nullptr);
+#else
+  (void)cells;
+  (void)numberOfTriangles;
+#endif
+}
+
+
+void
+STLMeshIO ::FinishMemoryMappedOutput()
+{
+#if !defined(_WIN32)
+  if (this->m_OutputFileDescriptor < 0)
   {
-    const auto cellType = static_cast<CellGeometryEnum>(cellsBuffer[index2++]);
-    const auto numberOfVerticesInCell = static_cast<IdentifierType>(cellsBuffer[index2++]);
+    return;
+  }
 
-    const bool isTriangle = (cellType == CellGeometryEnum::TRIANGLE_CELL) ||
-                            (cellType == CellGeometryEnum::POLYGON_CELL && numberOfVerticesInCell == 3);
+  bool succeeded = ::msync(this->m_OutputMapping, this->m_OutputMappingSize, MS_SYNC) == 0;
+  succeeded = (::munmap(this->m_OutputMapping, this->m_OutputMappingSize) == 0) && succeeded;
+  succeeded = (::close(this->m_OutputFileDescriptor) == 0) && succeeded;
 
-    if (isTriangle)
-    {
-      numberOfTriangles++;
-    }
-    else
-    {
-      itkExceptionMacro("Found Non-Triangular Cell.");
-    }
+  this->m_OutputMapping = nullptr;
+  this->m_OutputMappingSize = 0;
+  this->m_OutputFileDescriptor = -1;
 
-    index2 += numberOfVerticesInCell;
+  if (!succeeded)
+  {
+    itkExceptionMacro("Error writing file\n"
+                      "outputFilename= "
+                      << this->m_FileName);
   }
+#endif
+}
 
-  this->WriteInt32AsBinary(numberOfTriangles);
 
-  for (SizeValueType polygonItr = 0; polygonItr < numberOfPolygons; polygonItr++)
+void
+STLMeshIO ::ReleaseMemoryMappedOutput()
+{
+#if !defined(_WIN32)
+  if (this->m_OutputFileDescriptor < 0)
   {
-    // skip cell type and number of vertices in cell
-    index += 2;
+    return;
+  }
+
+  ::munmap(this->m_OutputMapping, this->m_OutputMappingSize);
+  ::close(this->m_OutputFileDescriptor);
 
-    const PointType & p0 = m_Points[cellsBuffer[index++]];
-    const PointType & p1 = m_Points[cellsBuffer[index++]];
-    const PointType & p2 = m_Points[cellsBuffer[index++]];
+  this->m_OutputMapping = nullptr;
+  this->m_OutputMappingSize = 0;
+  this->m_OutputFileDescriptor = -1;
+#endif
+}
 
-    const VectorType v10(p0 - p1);
-    const VectorType v12(p2 - p1);
 
-    CrossProduct(normal, v12, v10);
+void
+STLMeshIO ::WriteTriangleAsBinary(const PointType & p0, const PointType & p1, const PointType & p2, char * record)
+{
+  const VectorType v10(p0 - p1);
+  const VectorType v12(p2 - p1);
 
-    //
-    // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
-    //
-    //    foreach triangle
-    //    REAL32[3] – Normal vector
-    //    REAL32[3] – Vertex 1
-    //    REAL32[3] – Vertex 2
-    //    REAL32[3] – Vertex 3
-    //    UINT16 – Attribute byte count
-    //
-    this->WriteNormalAsBinary(normal);
-    this->WritePointAsBinary(p0);
-    this->WritePointAsBinary(p1);
-    this->WritePointAsBinary(p2);
-    this->WriteInt16AsBinary(0);
+  NormalType normal;
+  CrossProduct(normal, v12, v10);
+
+  //
+  // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
+  //
+  //    foreach triangle
+  //    REAL32[3] – Normal vector
+  //    REAL32[3] – Vertex 1
+  //    REAL32[3] – Vertex 2
+  //    REAL32[3] – Vertex 3
+  //    UINT16 – Attribute byte count
+  //
+  float values[12];
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    values[i] = normal[i];
+    values[3 + i] = p0[i];
+    values[6 + i] = p1[i];
+    values[9 + i] = p2[i];
   }
 
   //
-  // There is no ending section when doing BINARY
+  // Binary values in STL files are expected to be in little endian
+  // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
   //
+  ByteSwapper<float>::SwapRangeFromSystemToLittleEndian(values, 12);
+
+  std::memcpy(record, values, sizeof(values));
+
+  const uint16_t attributeByteCount = 0;
+  std::memcpy(record + sizeof(values), &attributeByteCount, sizeof(attributeByteCount));
 }
 
+
 void
 STLMeshIO ::WriteCellsAsAscii(void * buffer)
 {
+  const auto * cellsBuffer = reinterpret_cast<const IdentifierType *>(buffer);
 
-  const IdentifierType numberOfPolygons = this->GetNumberOfCells();
+  this->IndexCellsForWriting(cellsBuffer);
 
-  const auto * cellsBuffer = reinterpret_cast<const IdentifierType *>(buffer);
+  this->WriteTrianglesAsAscii(CellBufferView(cellsBuffer, this->m_CellOffsets, this->m_FirstTriangles));
+}
 
-  SizeValueType index = 0;
+
+template <typename TCellView>
+void
+STLMeshIO ::WriteTrianglesAsAscii(const TCellView & cells)
+{
+  const SizeValueType numberOfPolygons = this->GetNumberOfCells();
 
   NormalType normal;
 
+  AsciiFacetFormatter formatter;
+
   for (SizeValueType polygonItr = 0; polygonItr < numberOfPolygons; polygonItr++)
   {
-    const auto cellType = static_cast<CellGeometryEnum>(cellsBuffer[index++]);
-    const auto numberOfVerticesInCell = static_cast<IdentifierType>(cellsBuffer[index++]);
-
-    const bool isTriangle = (cellType == CellGeometryEnum::TRIANGLE_CELL) ||
-                            (cellType == CellGeometryEnum::POLYGON_CELL && numberOfVerticesInCell == 3);
+    const SizeValueType numberOfVerticesInCell = cells.GetNumberOfPoints(polygonItr);
+    const auto *        pointIds = cells.GetPointIds(polygonItr);
 
-    if (!isTriangle)
+    // Polygons are split into a fan of triangles around their first point
+    for (SizeValueType j = 1; j + 1 < numberOfVerticesInCell; ++j)
     {
-      itkExceptionMacro("Found Non-Triangular Cell.");
-    }
-
-    const PointType & p0 = m_Points[cellsBuffer[index++]];
-    const PointType & p1 = m_Points[cellsBuffer[index++]];
-    const PointType & p2 = m_Points[cellsBuffer[index++]];
+      const PointType & p0 = m_Points[pointIds[0]];
+      const PointType & p1 = m_Points[pointIds[j]];
+      const PointType & p2 = m_Points[pointIds[j + 1]];
 
-    const VectorType v10(p0 - p1);
-    const VectorType v12(p2 - p1);
+      const VectorType v10(p0 - p1);
+      const VectorType v12(p2 - p1);
 
-    CrossProduct(normal, v12, v10);
+      CrossProduct(normal, v12, v10);
 
-    this->m_OutputStream << "  facet normal ";
-    this->m_OutputStream << normal[0] << " " << normal[1] << " " << normal[2] << std::endl;
+      const size_t facetLength = formatter.Format(
+        normal.GetDataPointer(), p0.GetDataPointer(), p1.GetDataPointer(), p2.GetDataPointer());
 
-    this->m_OutputStream << "    outer loop" << std::endl;
-
-    this->m_OutputStream << "      vertex " << p0[0] << " " << p0[1] << " " << p0[2] << std::endl;
-    this->m_OutputStream << "      vertex " << p1[0] << " " << p1[1] << " " << p1[2] << std::endl;
-    this->m_OutputStream << "      vertex " << p2[0] << " " << p2[1] << " " << p2[2] << std::endl;
-
-    this->m_OutputStream << "    endloop" << std::endl;
-    this->m_OutputStream << "  endfacet" << std::endl;
+      this->WriteToOutput(formatter.GetText(), facetLength);
+    }
   }
 
-  this->m_OutputStream << "endsolid" << std::endl;
+  constexpr char footer[] = "endsolid\n";
+  this->WriteToOutput(footer, sizeof(footer) - 1);
 }
 
 void
@@ -680,156 +4821,523 @@ STLMeshIO ::WriteInt32AsBinary(int32_t value)
   // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
   //
   ByteSwapper<int32_t>::SwapFromSystemToLittleEndian(&value);
-  this->m_OutputStream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+  this->WriteToOutput(reinterpret_cast<const char *>(&value), sizeof(value));
 }
 
 
 void
-STLMeshIO ::WriteInt16AsBinary(int16_t value)
+STLMeshIO ::ReadInt32AsBinary(int32_t & value)
 {
+  this->m_InputStream.read(reinterpret_cast<char *>(&value), sizeof(value));
   //
   // Binary values in STL files are expected to be in little endian
   // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
   //
-  ByteSwapper<int16_t>::SwapFromSystemToLittleEndian(&value);
-  this->m_OutputStream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+  ByteSwapper<int32_t>::SwapFromSystemToLittleEndian(&value);
 }
 
 
 void
-STLMeshIO ::WriteNormalAsBinary(const NormalType & normal)
+STLMeshIO ::ReadPointAsBinary(const char * data, PointType & point)
 {
+  float value;
   for (unsigned int i = 0; i < 3; ++i)
   {
-    float value = normal[i];
+    std::memcpy(&value, data + i * sizeof(value), sizeof(value));
     //
     // Binary values in STL files are expected to be in little endian
     // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
     //
     ByteSwapper<float>::SwapFromSystemToLittleEndian(&value);
-    this->m_OutputStream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    point[i] = value;
   }
 }
 
 
 void
-STLMeshIO ::WritePointAsBinary(const PointType & point)
+STLMeshIO ::ReadPointAsAscii(PointType & point)
 {
+  std::getline(this->m_InputStream, this->m_InputLine, '\n');
+
+  const std::string::size_type position = this->m_InputLine.find("vertex");
+  if (position == std::string::npos)
+  {
+    itkExceptionMacro("Parsing error: missed 'vertex' in line " << this->m_InputLineNumber);
+  }
+
+  // The coordinates are converted in place: extracting them from the stream
+  // would allocate a string per coordinate.
+  const char * text = this->m_InputLine.c_str() + position + 6;
+  const char * end = this->m_InputLine.c_str() + this->m_InputLine.size();
   for (unsigned int i = 0; i < 3; ++i)
   {
-    float value = point[i];
-    //
-    // Binary values in STL files are expected to be in little endian
-    // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
-    //
-    ByteSwapper<float>::SwapFromSystemToLittleEndian(&value);
-    this->m_OutputStream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    float coordinate;
+    text = ParseAsciiFloat(text, end, coordinate);
+    if (text == nullptr)
+    {
+      itkExceptionMacro("Parsing error: missed coordinate in line " << this->m_InputLineNumber
+                                                                    << " found: " << this->m_InputLine);
+    }
+    point[i] = coordinate;
   }
+
+  this->m_InputLine.clear();
+  this->m_InputLineNumber++;
 }
 
 
 void
-STLMeshIO ::ReadNormalAsBinary(NormalType & normal)
+STLMeshIO ::InsertTriangle(const PointType & p0, const PointType & p1, const PointType & p2)
 {
-  float value;
-  for (unsigned int i = 0; i < 3; ++i)
+  if (this->IsPreview())
   {
-    this->m_InputStream.read(reinterpret_cast<char *>(&value), sizeof(value));
-    //
-    // Binary values in STL files are expected to be in little endian
-    // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
-    //
-    ByteSwapper<float>::SwapFromSystemToLittleEndian(&value);
-    normal[i] = value;
+    this->InsertTriangleIntoClusters(p0, p1, p2);
+    return;
+  }
+
+  this->m_PointInTriangleCounter = 0;
+
+  this->InsertPointIntoSet(p0);
+  this->InsertPointIntoSet(p1);
+  this->InsertPointIntoSet(p2);
+
+  //
+  // Duplicates are found once the points are merged, from the sorted point
+  // Ids of the triangle, whatever the orientation of the facets.
+  //
+  if (this->m_RemoveDuplicateTriangles)
+  {
+    TriangleKeyType key{ { this->m_TrianglePointIds.p0, this->m_TrianglePointIds.p1, this->m_TrianglePointIds.p2 } };
+    std::sort(key.begin(), key.end());
+
+    if (!this->m_TriangleKeys.insert(key).second)
+    {
+      ++this->m_NumberOfRemovedDuplicateTriangles;
+      if (this->m_ComputeStatistics)
+      {
+        this->m_Statistics.RemoveTriangle(p0, p1, p2);
+      }
+      return;
+    }
+  }
+
+  if (this->m_ReadPointsOnly)
+  {
+    return;
+  }
+
+  this->m_CellsVector.push_back(this->m_TrianglePointIds);
+}
+
+
+size_t
+STLMeshIO ::TriangleKeyHash::operator()(const TriangleKeyType & key) const
+{
+  size_t hash = 0;
+  for (const IdentifierType pointId : key)
+  {
+    hash = (hash ^ static_cast<size_t>(pointId)) * static_cast<size_t>(0x9E3779B97F4A7C15ULL);
   }
+  return hash;
 }
 
 
 void
-STLMeshIO ::ReadInt32AsBinary(int32_t & value)
+STLMeshIO ::SetTrianglePredicate(const TrianglePredicateType & predicate)
 {
-  this->m_InputStream.read(reinterpret_cast<char *>(&value), sizeof(value));
+  this->m_TrianglePredicate = predicate;
+  this->Modified();
+}
+
+
+void
+STLMeshIO ::InitializeWeldedMesh()
+{
+  this->m_WeldedPoints.clear();
+  this->m_PointIndex.clear();
+  this->m_CellsVector.clear();
+  this->m_PointInTriangleCounter = 0;
+  this->m_ClusterCellSize = 0.0;
+  this->m_ClusterKeys.clear();
+  this->m_ClusterIds.clear();
+  this->m_ClusterSums.clear();
+}
+
+
+void
+STLMeshIO ::InsertTriangleIntoClusters(const PointType & p0, const PointType & p1, const PointType & p2)
+{
+  const PointType * vertices[3] = { &p0, &p1, &p2 };
+
   //
-  // Binary values in STL files are expected to be in little endian
-  // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
+  // Without a given size, the cells start at about the size of the first
+  // triangle, that is, at full resolution.
   //
-  ByteSwapper<int32_t>::SwapFromSystemToLittleEndian(&value);
+  if (this->m_ClusterCellSize <= 0.0)
+  {
+    this->m_ClusterCellSize = this->m_PreviewCellSize;
+
+    if (this->m_ClusterCellSize <= 0.0)
+    {
+      double magnitude = 0.0;
+      for (unsigned int k = 0; k < 3; ++k)
+      {
+        this->m_ClusterCellSize =
+          std::max(this->m_ClusterCellSize, vertices[k]->EuclideanDistanceTo(*vertices[(k + 1) % 3]));
+        for (unsigned int i = 0; i < 3; ++i)
+        {
+          magnitude = std::max(magnitude, std::abs(double{ (*vertices[k])[i] }));
+        }
+      }
+      this->m_ClusterCellSize = std::max(this->m_ClusterCellSize, 1e-6 * (1.0 + magnitude));
+    }
+  }
+
+  //
+  // The clusters are indexed by the integer coordinates of their cell,
+  // which are exact far beyond the range where floats could tell
+  // neighboring cells apart.
+  //
+  TripletType triangle;
+  IdentifierType * pointIds[3] = { &triangle.p0, &triangle.p1, &triangle.p2 };
+  for (unsigned int k = 0; k < 3; ++k)
+  {
+    const PointType & vertex = *vertices[k];
+
+    ClusterKeyType key;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      key[i] = ClusterCoordinate(vertex[i] / this->m_ClusterCellSize);
+    }
+
+    const IdentifierType clusterId = this->FindOrInsertCluster(key);
+
+    ClusterSumType & cluster = this->m_ClusterSums[clusterId];
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      cluster.m_Sum[i] += vertex[i];
+    }
+    ++cluster.m_Count;
+
+    *pointIds[k] = clusterId;
+  }
+
+  if (triangle.p0 != triangle.p1 && triangle.p1 != triangle.p2 && triangle.p2 != triangle.p0)
+  {
+    this->m_CellsVector.push_back(triangle);
+  }
+
+  if (this->m_PreviewTargetNumberOfTriangles > 0 &&
+      2 * this->m_ClusterKeys.size() > std::max<SizeValueType>(this->m_PreviewTargetNumberOfTriangles, 16))
+  {
+    this->CoarsenClusters();
+  }
+}
+
+
+IdentifierType
+STLMeshIO ::FindOrInsertCluster(const ClusterKeyType & key)
+{
+  const auto inserted = this->m_ClusterIds.emplace(key, this->m_ClusterKeys.size());
+  if (inserted.second)
+  {
+    this->m_ClusterKeys.push_back(key);
+    this->m_ClusterSums.push_back(ClusterSumType{});
+  }
+  return inserted.first->second;
+}
+
+
+size_t
+STLMeshIO ::ClusterKeyHash::operator()(const ClusterKeyType & key) const
+{
+  size_t hash = 0;
+  for (const int64_t coordinate : key)
+  {
+    hash = (hash ^ static_cast<size_t>(coordinate)) * static_cast<size_t>(0x9E3779B97F4A7C15ULL);
+  }
+  return hash;
 }
 
 
 void
-STLMeshIO ::ReadInt16AsBinary(int16_t & value)
+STLMeshIO ::CoarsenClusters()
 {
-  this->m_InputStream.read(reinterpret_cast<char *>(&value), sizeof(value));
   //
-  // Binary values in STL files are expected to be in little endian
-  // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
+  // Doubling the size of the cells merges the clusters of the cells
+  // (2i, 2i + 1) of every axis into the cell i.
   //
-  ByteSwapper<int16_t>::SwapFromSystemToLittleEndian(&value);
+  this->m_ClusterCellSize *= 2.0;
+
+  std::vector<ClusterKeyType> keys;
+  std::vector<ClusterSumType> sums;
+  keys.swap(this->m_ClusterKeys);
+  sums.swap(this->m_ClusterSums);
+  this->m_ClusterIds.clear();
+
+  std::vector<IdentifierType> newIds(keys.size());
+  for (SizeValueType c = 0; c < keys.size(); ++c)
+  {
+    ClusterKeyType key;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      // Rounds toward negative infinity, like the cells of the grid.
+      key[i] = (keys[c][i] - (keys[c][i] < 0 ? 1 : 0)) / 2;
+    }
+
+    newIds[c] = this->FindOrInsertCluster(key);
+
+    ClusterSumType & cluster = this->m_ClusterSums[newIds[c]];
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      cluster.m_Sum[i] += sums[c].m_Sum[i];
+    }
+    cluster.m_Count += sums[c].m_Count;
+  }
+
+  CellsVectorType triangles;
+  triangles.swap(this->m_CellsVector);
+  for (SizeValueType t = 0; t < triangles.size(); ++t)
+  {
+    TripletType triangle = triangles[t];
+    triangle.p0 = newIds[triangle.p0];
+    triangle.p1 = newIds[triangle.p1];
+    triangle.p2 = newIds[triangle.p2];
+
+    if (triangle.p0 != triangle.p1 && triangle.p1 != triangle.p2 && triangle.p2 != triangle.p0)
+    {
+      this->m_CellsVector.push_back(triangle);
+    }
+  }
 }
 
 
 void
-STLMeshIO ::ReadPointAsBinary(PointType & point)
+STLMeshIO ::FinishClusters()
 {
-  float value;
-  for (unsigned int i = 0; i < 3; ++i)
+  //
+  // Keep one triangle per set of three clusters, and the clusters used by
+  // the remaining triangles, at the mean of their vertices.
+  //
+  const SizeValueType numberOfClusters = this->m_ClusterKeys.size();
+
+  TriangleKeySetType          keys;
+  CellsVectorType             triangles;
+  std::vector<IdentifierType> newIds(numberOfClusters, NumericTraits<IdentifierType>::max());
+  IdentifierType              numberOfPoints = 0;
+
+  triangles.swap(this->m_CellsVector);
+  for (SizeValueType t = 0; t < triangles.size(); ++t)
   {
-    this->m_InputStream.read(reinterpret_cast<char *>(&value), sizeof(value));
-    //
-    // Binary values in STL files are expected to be in little endian
-    // https://en.wikipedia.org/wiki/STL_(file_format)#Binary_STL
-    //
-    ByteSwapper<float>::SwapFromSystemToLittleEndian(&value);
-    point[i] = value;
+    TripletType     triangle = triangles[t];
+    TriangleKeyType key{ { triangle.p0, triangle.p1, triangle.p2 } };
+    std::sort(key.begin(), key.end());
+
+    if (!keys.insert(key).second)
+    {
+      if (this->m_RemoveDuplicateTriangles)
+      {
+        ++this->m_NumberOfRemovedDuplicateTriangles;
+      }
+      continue;
+    }
+
+    for (IdentifierType * pointId : { &triangle.p0, &triangle.p1, &triangle.p2 })
+    {
+      if (newIds[*pointId] == NumericTraits<IdentifierType>::max())
+      {
+        newIds[*pointId] = numberOfPoints++;
+      }
+      *pointId = newIds[*pointId];
+    }
+    this->m_CellsVector.push_back(triangle);
+  }
+
+  PointContainerType points(numberOfPoints);
+  for (SizeValueType c = 0; c < numberOfClusters; ++c)
+  {
+    if (newIds[c] != NumericTraits<IdentifierType>::max())
+    {
+      const ClusterSumType & cluster = this->m_ClusterSums[c];
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        points[newIds[c]][i] = static_cast<PointValueType>(cluster.m_Sum[i] / cluster.m_Count);
+      }
+    }
   }
 
-  this->InsertPointIntoSet(point);
+  this->m_WeldedPoints.swap(points);
+
+  // The clusters are only needed while the file is decoded.
+  std::vector<ClusterKeyType>().swap(this->m_ClusterKeys);
+  ClusterIdMapType().swap(this->m_ClusterIds);
+  std::vector<ClusterSumType>().swap(this->m_ClusterSums);
 }
 
 
 void
-STLMeshIO ::ReadPointAsAscii(PointType & point)
+STLMeshIO ::SetInputBuffer(const void * buffer, SizeValueType size)
+{
+  this->m_InputBuffer = static_cast<const char *>(buffer);
+  this->m_InputBufferSize = buffer != nullptr ? size : 0;
+  this->Modified();
+}
+
+
+void
+STLMeshIO ::ReleaseMemory()
+{
+  PointContainerType().swap(this->m_WeldedPoints);
+  this->m_PointIndex.Release();
+  CellsVectorType().swap(this->m_CellsVector);
+  std::vector<float>().swap(this->m_CachedPoints);
+  std::vector<uint32_t>().swap(this->m_CachedTriangles);
+  HalfEdgeNeighborsType().swap(this->m_HalfEdgeNeighbors);
+}
+
+
+void
+STLMeshIO ::InitializeTriangleFilter()
 {
-  std::string keyword;
-  this->m_InputStream >> keyword;
+  this->m_NumberOfRemovedDegenerateTriangles = 0;
+  this->m_NumberOfRemovedDuplicateTriangles = 0;
+  this->m_TriangleKeys.clear();
 
-  if (keyword.find("vertex") == std::string::npos)
+  if (!this->m_UseRegionOfInterest)
   {
-    itkExceptionMacro("Parsing error: missed 'vertex' in line " << this->m_InputLineNumber);
+    return;
   }
 
-  this->m_InputStream >> point;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    const double lower = this->m_RegionOfInterest[2 * i];
+    const double upper = this->m_RegionOfInterest[2 * i + 1];
+
+    if (lower > upper)
+    {
+      itkExceptionMacro("Invalid region of interest: lower bound " << lower << " is larger than upper bound " << upper);
+    }
 
-  this->InsertPointIntoSet(point);
+    this->m_RegionOfInterestCenter[i] = 0.5 * (lower + upper);
+    this->m_RegionOfInterestHalfSize[i] = 0.5 * (upper - lower);
+  }
+}
 
-  // read remaining of the line, most often just the end of line.
-  std::string restOfLine;
-  std::getline(this->m_InputStream, restOfLine, '\n');
 
-  this->m_InputLineNumber++;
+bool
+STLMeshIO ::AcceptTriangle(const PointType & p0, const PointType & p1, const PointType & p2) const
+{
+  if (this->m_UseRegionOfInterest && !this->TriangleIntersectsRegionOfInterest(p0, p1, p2))
+  {
+    return false;
+  }
+
+  if (this->m_TrianglePredicate && !this->m_TrianglePredicate(p0, p1, p2))
+  {
+    return false;
+  }
+
+  return true;
 }
 
 
-void
-STLMeshIO ::InsertPointIntoSet(const PointType & point)
+bool
+STLMeshIO ::IsDegenerateTriangle(const PointType & p0, const PointType & p1, const PointType & p2) const
 {
+  return TriangleArea(p0, p1, p2) <= this->m_DegenerateAreaThreshold;
+}
+
 
-  PointsMapType::const_iterator pointMapItr = this->m_PointsMap.find(point);
+bool
+STLMeshIO ::TriangleIntersectsRegionOfInterest(const PointType & p0, const PointType & p1, const PointType & p2) const
+{
+  //
+  // Separating axis test between a triangle and an axis-aligned box,
+  // after Akenine-Moller, "Fast 3D Triangle-Box Overlap Testing", 2001.
+  //
+  const double * center = this->m_RegionOfInterestCenter;
+  const double * halfSize = this->m_RegionOfInterestHalfSize;
 
-  IdentifierType pointId;
+  const PointType * const points[3] = { &p0, &p1, &p2 };
 
-  if (pointMapItr == this->m_PointsMap.end())
+  double v[3][3];
+  for (unsigned int k = 0; k < 3; ++k)
   {
-    this->m_PointsMap[point] = this->m_LatestPointId;
-    pointId = this->m_LatestPointId;
-    this->m_LatestPointId++;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      v[k][i] = (*points[k])[i] - center[i];
+    }
   }
-  else
+
+  // The triangle is separated from the box along the given axis when the
+  // projections of its vertices all fall outside of the projected box.
+  const auto separatedAlong = [&](const double axis[3]) {
+    double minimum = NumericTraits<double>::max();
+    double maximum = NumericTraits<double>::NonpositiveMin();
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+      const double projection = axis[0] * v[k][0] + axis[1] * v[k][1] + axis[2] * v[k][2];
+      minimum = std::min(minimum, projection);
+      maximum = std::max(maximum, projection);
+    }
+    const double radius =
+      halfSize[0] * std::abs(axis[0]) + halfSize[1] * std::abs(axis[1]) + halfSize[2] * std::abs(axis[2]);
+    return minimum > radius || maximum < -radius;
+  };
+
+  // Normals of the box faces
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    double axis[3] = { 0.0, 0.0, 0.0 };
+    axis[i] = 1.0;
+    if (separatedAlong(axis))
+    {
+      return false;
+    }
+  }
+
+  double edges[3][3];
+  for (unsigned int k = 0; k < 3; ++k)
+  {
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      edges[k][i] = v[(k + 1) % 3][i] - v[k][i];
+    }
+  }
+
+  // Normal of the triangle
+  const double normal[3] = { edges[0][1] * edges[1][2] - edges[0][2] * edges[1][1],
+                             edges[0][2] * edges[1][0] - edges[0][0] * edges[1][2],
+                             edges[0][0] * edges[1][1] - edges[0][1] * edges[1][0] };
+  if (separatedAlong(normal))
+  {
+    return false;
+  }
+
+  // Cross products of the triangle edges with the box axes
+  for (unsigned int k = 0; k < 3; ++k)
   {
-    pointId = pointMapItr->second;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      double axis[3] = { 0.0, 0.0, 0.0 };
+      axis[(i + 1) % 3] = -edges[k][(i + 2) % 3];
+      axis[(i + 2) % 3] = edges[k][(i + 1) % 3];
+      if (separatedAlong(axis))
+      {
+        return false;
+      }
+    }
   }
 
+  return true;
+}
+
+
+void
+STLMeshIO ::InsertPointIntoSet(const PointType & point)
+{
+  const IdentifierType pointId = this->m_PointIndex.FindOrInsert(point, this->m_WeldedPoints);
+
   switch (this->m_PointInTriangleCounter)
   {
     case 0:
@@ -867,10 +5375,10 @@ STLMeshIO ::GetUpdatePoints() const
 bool
 STLMeshIO ::GetUpdateCells() const
 {
-  // Always true, since we are reading the cell information
-  // in ReadMeshInformation(), and we need ReadCells() to be
+  // True unless only the points are read, since we are reading the cell
+  // information in ReadMeshInformation(), and we need ReadCells() to be
   // called in order to store the cell data into the buffer.
-  return true;
+  return !this->m_ReadPointsOnly;
 }
 
 
@@ -878,6 +5386,36 @@ void
 STLMeshIO ::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+
+  os << indent << "UseRegionOfInterest: " << (this->m_UseRegionOfInterest ? "On" : "Off") << std::endl;
+  os << indent << "RegionOfInterest: " << this->m_RegionOfInterest << std::endl;
+  os << indent << "TrianglePredicate: " << (this->m_TrianglePredicate ? "set" : "(none)") << std::endl;
+  os << indent << "UseSpatialIndex: " << (this->m_UseSpatialIndex ? "On" : "Off") << std::endl;
+  os << indent << "RemoveDegenerateTriangles: " << (this->m_RemoveDegenerateTriangles ? "On" : "Off") << std::endl;
+  os << indent << "DegenerateAreaThreshold: " << this->m_DegenerateAreaThreshold << std::endl;
+  os << indent << "RemoveDuplicateTriangles: " << (this->m_RemoveDuplicateTriangles ? "On" : "Off") << std::endl;
+  os << indent << "ComputeEdgeAdjacency: " << (this->m_ComputeEdgeAdjacency ? "On" : "Off") << std::endl;
+  os << indent << "ComputeStatistics: " << (this->m_ComputeStatistics ? "On" : "Off") << std::endl;
+  os << indent << "ReorderForLocality: " << (this->m_ReorderForLocality ? "On" : "Off") << std::endl;
+  os << indent << "DeferParsing: " << (this->m_DeferParsing ? "On" : "Off") << std::endl;
+  os << indent << "ReadPointsOnly: " << (this->m_ReadPointsOnly ? "On" : "Off") << std::endl;
+  os << indent << "UseDirectRead: " << (this->m_UseDirectRead ? "On" : "Off") << std::endl;
+  os << indent << "InputBuffer: " << static_cast<const void *>(this->m_InputBuffer) << std::endl;
+  os << indent << "InputBufferSize: " << this->m_InputBufferSize << std::endl;
+  os << indent << "UseWeldedMeshCache: " << (this->m_UseWeldedMeshCache ? "On" : "Off") << std::endl;
+  os << indent << "ReadFromWeldedMeshCache: " << (this->m_ReadFromWeldedMeshCache ? "On" : "Off") << std::endl;
+  os << indent << "UseExternalMemoryWeld: " << (this->m_UseExternalMemoryWeld ? "On" : "Off") << std::endl;
+  os << indent << "WeldMemoryBudget: " << this->m_WeldMemoryBudget << std::endl;
+  os << indent << "ScratchDirectory: " << this->m_ScratchDirectory << std::endl;
+  os << indent << "PreviewCellSize: " << this->m_PreviewCellSize << std::endl;
+  os << indent << "PreviewTargetNumberOfTriangles: " << this->m_PreviewTargetNumberOfTriangles << std::endl;
+  os << indent << "TriangulatePolygons: " << (this->m_TriangulatePolygons ? "On" : "Off") << std::endl;
+  os << indent << "AppendToFile: " << (this->m_AppendToFile ? "On" : "Off") << std::endl;
+  os << indent << "NumberOfShards: " << this->m_NumberOfShards << std::endl;
+  os << indent << "ShardAxis: " << this->m_ShardAxis << std::endl;
+  os << indent << "UseMemoryMappedWriter: " << (this->m_UseMemoryMappedWriter ? "On" : "Off") << std::endl;
+  os << indent << "UseBackgroundWriter: " << (this->m_UseBackgroundWriter ? "On" : "Off") << std::endl;
+  os << indent << "OutputBuffer: " << static_cast<const void *>(this->m_OutputBuffer) << std::endl;
 }
 
 } // end of namespace itk
@@ -0,0 +1,108 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMesh.h"
+#include "itkSTLMeshBatchReader.h"
+#include "itkTestingMacros.h"
+
+int
+itkSTLMeshBatchReaderTest(int argc, char * argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Missing Arguments." << std::endl;
+    std::cerr << "Usage: " << std::endl;
+    std::cerr << "inputMesh1 inputMesh2 [inputMesh3 ...]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  constexpr unsigned int Dimension = 3;
+  using PixelType = float;
+
+  using MeshType = itk::Mesh<PixelType, Dimension>;
+
+  using BatchReaderType = itk::STLMeshBatchReader<MeshType>;
+
+  BatchReaderType::Pointer batchReader = BatchReaderType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(batchReader, STLMeshBatchReader, Object);
+
+  ITK_TEST_SET_GET_BOOLEAN(batchReader, MergeParts, false);
+  ITK_TEST_SET_GET_BOOLEAN(batchReader, WeldAcrossParts, false);
+
+  // The input files, followed by a file that does not exist
+  BatchReaderType::FileNamesContainerType fileNames(argv + 1, argv + argc);
+  fileNames.emplace_back("nonexistent.stl");
+
+  const auto numberOfFiles = static_cast<itk::SizeValueType>(fileNames.size());
+
+  batchReader->SetFileNames(fileNames);
+
+  //
+  // One mesh per file
+  //
+  ITK_TRY_EXPECT_NO_EXCEPTION(batchReader->Update());
+
+  ITK_TEST_EXPECT_EQUAL(batchReader->GetNumberOfFailures(), 1);
+  ITK_TEST_EXPECT_TRUE(batchReader->GetOutput(numberOfFiles - 1) == nullptr);
+  ITK_TEST_EXPECT_TRUE(!batchReader->GetErrorMessage(numberOfFiles - 1).empty());
+
+  itk::SizeValueType numberOfPoints = 0;
+  itk::SizeValueType numberOfCells = 0;
+  for (itk::SizeValueType fileIndex = 0; fileIndex + 1 < numberOfFiles; ++fileIndex)
+  {
+    ITK_TEST_EXPECT_TRUE(batchReader->GetErrorMessage(fileIndex).empty());
+
+    const MeshType * mesh = batchReader->GetOutput(fileIndex);
+    ITK_TEST_EXPECT_TRUE(mesh != nullptr);
+
+    numberOfPoints += mesh->GetNumberOfPoints();
+    numberOfCells += mesh->GetNumberOfCells();
+  }
+
+  //
+  // Merged mesh, with the part index of every cell
+  //
+  batchReader->MergePartsOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(batchReader->Update());
+
+  const MeshType * mergedMesh = batchReader->GetMergedOutput();
+  ITK_TEST_EXPECT_EQUAL(mergedMesh->GetNumberOfPoints(), numberOfPoints);
+  ITK_TEST_EXPECT_EQUAL(mergedMesh->GetNumberOfCells(), numberOfCells);
+
+  PixelType partIndex = -1;
+  mergedMesh->GetCellData(numberOfCells - 1, &partIndex);
+  ITK_TEST_EXPECT_EQUAL(partIndex, static_cast<PixelType>(numberOfFiles - 2));
+
+  //
+  // Merged mesh, reading every part twice and welding across parts
+  //
+  BatchReaderType::FileNamesContainerType duplicatedFileNames(argv + 1, argv + argc);
+  duplicatedFileNames.insert(duplicatedFileNames.end(), argv + 1, argv + argc);
+
+  batchReader->SetFileNames(duplicatedFileNames);
+  batchReader->WeldAcrossPartsOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(batchReader->Update());
+
+  ITK_TEST_EXPECT_EQUAL(batchReader->GetNumberOfFailures(), 0);
+  ITK_TEST_EXPECT_EQUAL(batchReader->GetMergedOutput()->GetNumberOfCells(), 2 * numberOfCells);
+  ITK_TEST_EXPECT_TRUE(batchReader->GetMergedOutput()->GetNumberOfPoints() <= numberOfPoints);
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
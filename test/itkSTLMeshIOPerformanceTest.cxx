@@ -0,0 +1,462 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMath.h"
+#include "itkSTLMeshIO.h"
+#include "itkTestingMacros.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <string>
+#include <vector>
+
+//
+//  Instrumented allocator: the test driver counts every allocation made
+//  through the global operator new, and tracks the peak number of bytes
+//  allocated since the last call to ResetAllocationCounters().
+//
+namespace
+{
+std::atomic<itk::SizeValueType> numberOfAllocations{ 0 };
+std::atomic<itk::SizeValueType> allocatedBytes{ 0 };
+std::atomic<itk::SizeValueType> peakAllocatedBytes{ 0 };
+
+// The size of every block is stored in front of it, so that it is known
+// when the block is released.
+constexpr std::size_t AllocationHeaderSize = alignof(std::max_align_t);
+
+void *
+CountedAllocate(std::size_t size) noexcept
+{
+  auto * block = static_cast<char *>(std::malloc(size + AllocationHeaderSize));
+  if (block == nullptr)
+  {
+    return nullptr;
+  }
+  *reinterpret_cast<std::size_t *>(block) = size;
+
+  ++numberOfAllocations;
+  const itk::SizeValueType bytes = (allocatedBytes += size);
+  itk::SizeValueType       peak = peakAllocatedBytes.load();
+  while (bytes > peak && !peakAllocatedBytes.compare_exchange_weak(peak, bytes))
+  {
+  }
+
+  return block + AllocationHeaderSize;
+}
+
+void
+CountedRelease(void * pointer) noexcept
+{
+  if (pointer == nullptr)
+  {
+    return;
+  }
+  char * block = static_cast<char *>(pointer) - AllocationHeaderSize;
+  allocatedBytes -= *reinterpret_cast<std::size_t *>(block);
+  std::free(block);
+}
+
+void *
+CountedAllocateOrThrow(std::size_t size)
+{
+  void * pointer = CountedAllocate(size);
+  if (pointer == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void
+ResetAllocationCounters()
+{
+  numberOfAllocations = 0;
+  peakAllocatedBytes = allocatedBytes.load();
+}
+} // namespace
+
+void *
+operator new(std::size_t size)
+{
+  return CountedAllocateOrThrow(size);
+}
+
+void *
+operator new[](std::size_t size)
+{
+  return CountedAllocateOrThrow(size);
+}
+
+void *
+operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+  return CountedAllocate(size);
+}
+
+void *
+operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+  return CountedAllocate(size);
+}
+
+void
+operator delete(void * pointer) noexcept
+{
+  CountedRelease(pointer);
+}
+
+void
+operator delete[](void * pointer) noexcept
+{
+  CountedRelease(pointer);
+}
+
+void
+operator delete(void * pointer, std::size_t) noexcept
+{
+  CountedRelease(pointer);
+}
+
+void
+operator delete[](void * pointer, std::size_t) noexcept
+{
+  CountedRelease(pointer);
+}
+
+void
+operator delete(void * pointer, const std::nothrow_t &) noexcept
+{
+  CountedRelease(pointer);
+}
+
+void
+operator delete[](void * pointer, const std::nothrow_t &) noexcept
+{
+  CountedRelease(pointer);
+}
+
+namespace
+{
+//
+//  The limits that a read or a write must meet: the number of allocations,
+//  and the peak number of bytes allocated, per triangle. The peak includes
+//  the buffers of the caller, and the points and cells held by the reader.
+//  An allocation per vertex or per line gives at least one allocation per
+//  triangle, far above the limits.
+//
+struct PerformanceLimits
+{
+  const char * m_Name;
+  double       m_AllocationsPerTriangle;
+  double       m_PeakBytesPerTriangle;
+};
+
+// Duration of the last operation measured, to compare operations of the
+// same run.
+std::chrono::duration<double> lastOperationDuration{ 0.0 };
+
+// Measures an operation, and reports whether it is within the limits. A
+// minimum throughput of 0 disables the check of the throughput.
+template <typename TOperation>
+bool
+MeasureOperation(const PerformanceLimits & limits,
+                 itk::SizeValueType        numberOfTriangles,
+                 double                    minimumTrianglesPerSecond,
+                 TOperation &&             operation)
+{
+  const itk::SizeValueType baselineBytes = allocatedBytes.load();
+  ResetAllocationCounters();
+
+  const auto start = std::chrono::steady_clock::now();
+  operation();
+  const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+  lastOperationDuration = seconds;
+
+  const double allocationsPerTriangle = static_cast<double>(numberOfAllocations.load()) / numberOfTriangles;
+  const double peakBytesPerTriangle =
+    static_cast<double>(peakAllocatedBytes.load() - baselineBytes) / numberOfTriangles;
+  const double trianglesPerSecond = numberOfTriangles / std::max(seconds.count(), 1e-9);
+
+  std::cout << limits.m_Name << ": " << allocationsPerTriangle << " allocations per triangle, "
+            << peakBytesPerTriangle << " peak bytes per triangle, " << trianglesPerSecond << " triangles per second"
+            << std::endl;
+
+  bool withinLimits = true;
+  if (allocationsPerTriangle > limits.m_AllocationsPerTriangle)
+  {
+    std::cerr << limits.m_Name << ": more than " << limits.m_AllocationsPerTriangle << " allocations per triangle"
+              << std::endl;
+    withinLimits = false;
+  }
+  if (peakBytesPerTriangle > limits.m_PeakBytesPerTriangle)
+  {
+    std::cerr << limits.m_Name << ": more than " << limits.m_PeakBytesPerTriangle << " peak bytes per triangle"
+              << std::endl;
+    withinLimits = false;
+  }
+  if (minimumTrianglesPerSecond > 0.0 && trianglesPerSecond < minimumTrianglesPerSecond)
+  {
+    std::cerr << limits.m_Name << ": less than " << minimumTrianglesPerSecond << " triangles per second"
+              << std::endl;
+    withinLimits = false;
+  }
+  return withinLimits;
+}
+
+// Reads a whole mesh into the buffers of the caller, in the order of
+// MeshFileReader.
+void
+ReadMesh(itk::STLMeshIO * meshIO, const std::string & fileName)
+{
+  meshIO->SetFileName(fileName);
+  meshIO->ReadMeshInformation();
+
+  if (meshIO->GetUpdatePoints())
+  {
+    std::vector<float> points(3 * meshIO->GetNumberOfPoints());
+    meshIO->ReadPoints(points.data());
+  }
+
+  if (meshIO->GetUpdateCells())
+  {
+    std::vector<itk::IdentifierType> cells(meshIO->GetCellBufferSize());
+    meshIO->ReadCells(cells.data());
+  }
+}
+} // namespace
+
+int
+itkSTLMeshIOPerformanceTest(int argc, char * argv[])
+{
+  if (argc < 4)
+  {
+    std::cerr << "Missing Arguments." << std::endl;
+    std::cerr << "Usage: " << std::endl;
+    std::cerr << "outputFilePrefix resolution minimumTrianglesPerSecond (0 to only report the throughput)"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const std::string prefix = argv[1];
+  const auto        resolution = static_cast<itk::SizeValueType>(std::atol(argv[2]));
+  const double      minimumTrianglesPerSecond = std::atof(argv[3]);
+
+  //
+  //  A closed sphere of resolution x resolution quads, split in triangles
+  //  except at the poles
+  //
+  const itk::SizeValueType numberOfPoints = (resolution + 1) * resolution;
+  const itk::SizeValueType numberOfTriangles = 2 * resolution * (resolution - 1);
+
+  std::vector<float> points;
+  points.reserve(3 * numberOfPoints);
+  for (itk::SizeValueType i = 0; i <= resolution; ++i)
+  {
+    const double theta = itk::Math::pi * i / resolution;
+    for (itk::SizeValueType j = 0; j < resolution; ++j)
+    {
+      const double phi = 2.0 * itk::Math::pi * j / resolution;
+      points.push_back(static_cast<float>(std::sin(theta) * std::cos(phi)));
+      points.push_back(static_cast<float>(std::sin(theta) * std::sin(phi)));
+      points.push_back(static_cast<float>(std::cos(theta)));
+    }
+  }
+
+  const auto triangleCell = static_cast<itk::IdentifierType>(itk::CommonEnums::CellGeometry::TRIANGLE_CELL);
+  const auto pointId = [resolution](itk::SizeValueType i, itk::SizeValueType j) {
+    return static_cast<itk::IdentifierType>(i * resolution + j % resolution);
+  };
+
+  std::vector<itk::IdentifierType> cells;
+  cells.reserve(5 * numberOfTriangles);
+  for (itk::SizeValueType i = 0; i < resolution; ++i)
+  {
+    for (itk::SizeValueType j = 0; j < resolution; ++j)
+    {
+      if (i != resolution - 1)
+      {
+        cells.insert(cells.end(), { triangleCell, 3, pointId(i, j), pointId(i + 1, j), pointId(i + 1, j + 1) });
+      }
+      if (i != 0)
+      {
+        cells.insert(cells.end(), { triangleCell, 3, pointId(i, j), pointId(i + 1, j + 1), pointId(i, j + 1) });
+      }
+    }
+  }
+
+  const auto writeMesh = [&](itk::STLMeshIO * meshIO, const std::string & fileName, bool binary) {
+    meshIO->SetFileName(fileName);
+    if (binary)
+    {
+      meshIO->SetFileTypeAsBINARY();
+    }
+    else
+    {
+      meshIO->SetFileTypeAsASCII();
+    }
+    meshIO->SetNumberOfPoints(numberOfPoints);
+    meshIO->SetNumberOfCells(numberOfTriangles);
+    meshIO->SetPointComponentType(itk::MeshIOBase::MapComponentType<float>::CType);
+    meshIO->SetCellComponentType(itk::MeshIOBase::MapComponentType<itk::IdentifierType>::CType);
+    meshIO->WriteMeshInformation();
+    meshIO->WritePoints(points.data());
+    meshIO->WriteCells(cells.data());
+    meshIO->Write();
+  };
+
+  const std::string asciiFileName = prefix + "Ascii.stl";
+  const std::string binaryFileName = prefix + "Binary.stl";
+
+  bool withinLimits = true;
+
+  //
+  //  Writing: the output is formatted in chunks of a fixed size, so that
+  //  neither the number of allocations nor the memory grows with the number
+  //  of triangles, except for the in-memory output that holds the file.
+  //
+  {
+    itk::STLMeshIO::Pointer meshIO = itk::STLMeshIO::New();
+    ITK_TRY_EXPECT_NO_EXCEPTION(withinLimits &= MeasureOperation(
+                                  { "Write ASCII", 0.05, 16.0 }, numberOfTriangles, minimumTrianglesPerSecond, [&] {
+                                    writeMesh(meshIO, asciiFileName, false);
+                                  }));
+  }
+  const std::chrono::duration<double> asciiWriteDuration = lastOperationDuration;
+  {
+    itk::STLMeshIO::Pointer meshIO = itk::STLMeshIO::New();
+    ITK_TRY_EXPECT_NO_EXCEPTION(withinLimits &= MeasureOperation(
+                                  { "Write BINARY", 0.05, 16.0 }, numberOfTriangles, minimumTrianglesPerSecond, [&] {
+                                    writeMesh(meshIO, binaryFileName, true);
+                                  }));
+  }
+  {
+    itk::STLMeshIO::Pointer meshIO = itk::STLMeshIO::New();
+    meshIO->UseBackgroundWriterOn();
+    ITK_TRY_EXPECT_NO_EXCEPTION(
+      withinLimits &= MeasureOperation({ "Write BINARY with the background writer", 0.05, 32.0 },
+                                       numberOfTriangles,
+                                       minimumTrianglesPerSecond,
+                                       [&] { writeMesh(meshIO, prefix + "Background.stl", true); }));
+  }
+  {
+    itk::STLMeshIO::Pointer meshIO = itk::STLMeshIO::New();
+    meshIO->UseMemoryMappedWriterOn();
+    ITK_TRY_EXPECT_NO_EXCEPTION(
+      withinLimits &= MeasureOperation({ "Write BINARY with the memory-mapped writer", 0.05, 16.0 },
+                                       numberOfTriangles,
+                                       minimumTrianglesPerSecond,
+                                       [&] { writeMesh(meshIO, prefix + "MemoryMapped.stl", true); }));
+  }
+  {
+    std::vector<char>       outputBuffer;
+    itk::STLMeshIO::Pointer meshIO = itk::STLMeshIO::New();
+    meshIO->SetOutputBuffer(&outputBuffer);
+    ITK_TRY_EXPECT_NO_EXCEPTION(
+      withinLimits &= MeasureOperation({ "Write BINARY to memory", 0.05, 72.0 },
+                                       numberOfTriangles,
+                                       minimumTrianglesPerSecond,
+                                       [&] { writeMesh(meshIO, prefix + "Memory.stl", true); }));
+  }
+
+  //
+  //  Reading: the points are welded and the cells are filled without an
+  //  allocation per vertex. The peak covers the welded points, the cells,
+  //  the weld table, and the buffers of the caller.
+  //
+  {
+    itk::STLMeshIO::Pointer meshIO = itk::STLMeshIO::New();
+    ITK_TRY_EXPECT_NO_EXCEPTION(withinLimits &= MeasureOperation({ "Read ASCII", 0.05, 112.0 },
+                                                                 numberOfTriangles,
+                                                                 minimumTrianglesPerSecond,
+                                                                 [&] { ReadMesh(meshIO, asciiFileName); }));
+  }
+  const std::chrono::duration<double> asciiReadDuration = lastOperationDuration;
+  {
+    itk::STLMeshIO::Pointer meshIO = itk::STLMeshIO::New();
+    ITK_TRY_EXPECT_NO_EXCEPTION(withinLimits &= MeasureOperation({ "Read BINARY", 0.05, 112.0 },
+                                                                 numberOfTriangles,
+                                                                 minimumTrianglesPerSecond,
+                                                                 [&] { ReadMesh(meshIO, binaryFileName); }));
+  }
+  {
+    itk::STLMeshIO::Pointer meshIO = itk::STLMeshIO::New();
+    meshIO->DeferParsingOn();
+    ITK_TRY_EXPECT_NO_EXCEPTION(withinLimits &= MeasureOperation({ "Read BINARY with deferred parsing", 0.05, 112.0 },
+                                                                 numberOfTriangles,
+                                                                 minimumTrianglesPerSecond,
+                                                                 [&] { ReadMesh(meshIO, binaryFileName); }));
+  }
+  {
+    itk::STLMeshIO::Pointer meshIO = itk::STLMeshIO::New();
+    meshIO->ReadPointsOnlyOn();
+    ITK_TRY_EXPECT_NO_EXCEPTION(withinLimits &= MeasureOperation({ "Read BINARY points only", 0.05, 56.0 },
+                                                                 numberOfTriangles,
+                                                                 minimumTrianglesPerSecond,
+                                                                 [&] { ReadMesh(meshIO, binaryFileName); }));
+  }
+  {
+    itk::STLMeshIO::Pointer meshIO = itk::STLMeshIO::New();
+    meshIO->UseDirectReadOn();
+    ITK_TRY_EXPECT_NO_EXCEPTION(withinLimits &= MeasureOperation({ "Read BINARY with direct reads", 0.05, 112.0 },
+                                                                 numberOfTriangles,
+                                                                 minimumTrianglesPerSecond,
+                                                                 [&] { ReadMesh(meshIO, binaryFileName); }));
+  }
+  {
+    std::ifstream     binaryFile(binaryFileName, std::ios::in | std::ios::binary);
+    std::vector<char> inputBuffer((std::istreambuf_iterator<char>(binaryFile)), std::istreambuf_iterator<char>());
+
+    itk::STLMeshIO::Pointer meshIO = itk::STLMeshIO::New();
+    meshIO->SetInputBuffer(inputBuffer.data(), inputBuffer.size());
+    ITK_TRY_EXPECT_NO_EXCEPTION(withinLimits &= MeasureOperation({ "Read BINARY from memory", 0.05, 112.0 },
+                                                                 numberOfTriangles,
+                                                                 minimumTrianglesPerSecond,
+                                                                 [&] { ReadMesh(meshIO, binaryFileName); }));
+  }
+
+  //
+  //  Writing an ASCII file formats the text that reading it parses, so that
+  //  both take about the same time whatever the machine and the build type.
+  //  A flush per line, or any other call to the file system per triangle,
+  //  makes the write several times slower than the read.
+  //
+  constexpr double maximumAsciiWriteToReadRatio = 3.0;
+  std::cout << "Write ASCII / Read ASCII: " << asciiWriteDuration / asciiReadDuration << std::endl;
+  if (asciiWriteDuration > maximumAsciiWriteToReadRatio * asciiReadDuration)
+  {
+    std::cerr << "Write ASCII: more than " << maximumAsciiWriteToReadRatio << " times the time of Read ASCII"
+              << std::endl;
+    withinLimits = false;
+  }
+
+  if (!withinLimits)
+  {
+    std::cerr << "Test failed!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -16,12 +16,155 @@
  *
  *=========================================================================*/
 
+#include "itkMath.h"
+#include "itkMesh.h"
 #include "itkQuadEdgeMesh.h"
 #include "itkSTLMeshIOFactory.h"
 #include "itkSTLMeshIO.h"
 #include "itkMeshFileReader.h"
 #include "itkMeshFileWriter.h"
+#include "itkMetaDataObject.h"
+#include "itkPolygonCell.h"
+#include "itkQuadrilateralCell.h"
 #include "itkTestingMacros.h"
+#include "itkTriangleCell.h"
+#include "itksys/SystemTools.hxx"
+
+#include <clocale>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <locale>
+#include <string>
+
+namespace
+{
+// Decimal comma of the C++ locale set by CommaLocaleGuard.
+class CommaNumericPunctuation : public std::numpunct<char>
+{
+protected:
+  char
+  do_decimal_point() const override
+  {
+    return ',';
+  }
+};
+
+// Switch the C and C++ locales of the process to a decimal comma, as a
+// German host application would, and restore them when destroyed. The C
+// locale is only switched when one of the usual comma locales is installed.
+class CommaLocaleGuard
+{
+public:
+  CommaLocaleGuard()
+    : m_PreviousCLocale(std::setlocale(LC_ALL, nullptr))
+    , m_PreviousLocale(std::locale::global(std::locale(std::locale::classic(), new CommaNumericPunctuation)))
+  {
+    for (const char * name : { "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR.utf8", "fr_FR", "German" })
+    {
+      if (std::setlocale(LC_ALL, name) != nullptr)
+      {
+        break;
+      }
+    }
+  }
+
+  ~CommaLocaleGuard()
+  {
+    std::locale::global(this->m_PreviousLocale);
+    std::setlocale(LC_ALL, this->m_PreviousCLocale.c_str());
+  }
+
+private:
+  std::string m_PreviousCLocale;
+  std::locale m_PreviousLocale;
+};
+
+// Meshes of known geometry, which do not have to be 2-manifolds.
+using TestMeshType = itk::Mesh<float, 3>;
+
+// Append the triangle (a, b, c) to the cells of the mesh.
+void
+AddTriangle(TestMeshType *                mesh,
+            TestMeshType::PointIdentifier a,
+            TestMeshType::PointIdentifier b,
+            TestMeshType::PointIdentifier c)
+{
+  using TriangleCellType = itk::TriangleCell<TestMeshType::CellType>;
+
+  TestMeshType::CellAutoPointer cell;
+  cell.TakeOwnership(new TriangleCellType);
+  cell->SetPointId(0, a);
+  cell->SetPointId(1, b);
+  cell->SetPointId(2, c);
+  mesh->SetCell(mesh->GetNumberOfCells(), cell);
+}
+
+// Unit tetrahedron with outward normals: point 0 is the origin and point
+// i + 1 is at 1 along axis i. Its triangles first use the points in the
+// order 1, 2, 3, 0.
+TestMeshType::Pointer
+MakeTetrahedron()
+{
+  TestMeshType::Pointer mesh = TestMeshType::New();
+
+  TestMeshType::PointType point;
+  point.Fill(0.0);
+  mesh->SetPoint(0, point);
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    point.Fill(0.0);
+    point[i] = 1.0;
+    mesh->SetPoint(i + 1, point);
+  }
+
+  AddTriangle(mesh, 1, 2, 3);
+  AddTriangle(mesh, 0, 2, 1);
+  AddTriangle(mesh, 0, 1, 3);
+  AddTriangle(mesh, 0, 3, 2);
+
+  return mesh;
+}
+
+// Write the mesh to a binary STL file through the given STLMeshIO.
+void
+WriteTestMesh(TestMeshType * mesh, const std::string & fileName, itk::STLMeshIO * meshIO)
+{
+  using TestWriterType = itk::MeshFileWriter<TestMeshType>;
+
+  TestWriterType::Pointer writer = TestWriterType::New();
+  writer->SetFileName(fileName);
+  writer->SetMeshIO(meshIO);
+  writer->SetInput(mesh);
+  writer->SetFileTypeAsBINARY();
+  writer->Update();
+}
+
+// Read an STL file through the given STLMeshIO.
+TestMeshType::Pointer
+ReadTestMesh(const std::string & fileName, itk::STLMeshIO * meshIO)
+{
+  using TestReaderType = itk::MeshFileReader<TestMeshType>;
+
+  TestReaderType::Pointer reader = TestReaderType::New();
+  reader->SetFileName(fileName);
+  reader->SetMeshIO(meshIO);
+  reader->Update();
+
+  return reader->GetOutput();
+}
+
+// Gives the test access to the storage of the point Ids of the triangles.
+class CellsVectorTestMeshIO : public itk::STLMeshIO
+{
+public:
+  using CellsVectorType = itk::STLMeshIO::CellsVectorType;
+  using TripletType = itk::STLMeshIO::TripletType;
+};
+} // namespace
 
 int
 itkSTLMeshIOTest(int argc, char * argv[])
@@ -30,7 +173,7 @@ itkSTLMeshIOTest(int argc, char * argv[])
   {
     std::cerr << "Missing Arguments." << std::endl;
     std::cerr << "Usage: " << std::endl;
-    std::cerr << "inputMesh outputMesh (0:ASCII/1:BINARY) " << std::endl;
+    std::cerr << "inputMesh outputMesh (0:ASCII/1:BINARY) [useBackgroundWriter] [deferParsing] [useMemoryMappedWriter]" << std::endl;
     return EXIT_FAILURE;
   }
 
@@ -61,6 +204,24 @@ itkSTLMeshIOTest(int argc, char * argv[])
     writer->SetFileTypeAsBINARY();
   }
 
+  if (argc > 4)
+  {
+    itk::STLMeshIO::Pointer writerMeshIO = itk::STLMeshIO::New();
+    writerMeshIO->SetUseBackgroundWriter(static_cast<bool>(atoi(argv[4])));
+    if (argc > 6)
+    {
+      writerMeshIO->SetUseMemoryMappedWriter(static_cast<bool>(atoi(argv[6])));
+    }
+    writer->SetMeshIO(writerMeshIO);
+  }
+
+  if (argc > 5)
+  {
+    itk::STLMeshIO::Pointer readerMeshIO = itk::STLMeshIO::New();
+    readerMeshIO->SetDeferParsing(static_cast<bool>(atoi(argv[5])));
+    reader->SetMeshIO(readerMeshIO);
+  }
+
   reader->Update();
   QEMeshType * mesh = reader->GetOutput();
 
@@ -68,6 +229,646 @@ itkSTLMeshIOTest(int argc, char * argv[])
 
   ITK_TRY_EXPECT_NO_EXCEPTION(writer->Update());
 
+  //
+  //  Reading the output again with the same STLMeshIO gives the same mesh
+  //
+  itk::STLMeshIO::Pointer reusedMeshIO = itk::STLMeshIO::New();
+
+  itk::SizeValueType  numberOfPoints = 0;
+  itk::SizeValueType  numberOfCells = 0;
+  QEMeshType::Pointer outputMesh;
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    ReaderType::Pointer outputReader = ReaderType::New();
+    outputReader->SetFileName(argv[2]);
+    outputReader->SetMeshIO(reusedMeshIO);
+    ITK_TRY_EXPECT_NO_EXCEPTION(outputReader->Update());
+
+    if (i == 0)
+    {
+      outputMesh = outputReader->GetOutput();
+      numberOfPoints = outputReader->GetOutput()->GetNumberOfPoints();
+      numberOfCells = outputReader->GetOutput()->GetNumberOfCells();
+    }
+    ITK_TEST_EXPECT_EQUAL(outputReader->GetOutput()->GetNumberOfPoints(), numberOfPoints);
+    ITK_TEST_EXPECT_EQUAL(outputReader->GetOutput()->GetNumberOfCells(), numberOfCells);
+  }
+
+  reusedMeshIO->ReleaseMemory();
+
+  //
+  //  Points read as double coordinates are the same as the float ones
+  //
+  itk::STLMeshIO::Pointer doubleMeshIO = itk::STLMeshIO::New();
+  doubleMeshIO->SetPointComponentType(itk::IOComponentEnum::DOUBLE);
+
+  ReaderType::Pointer doubleReader = ReaderType::New();
+  doubleReader->SetFileName(argv[2]);
+  doubleReader->SetMeshIO(doubleMeshIO);
+  ITK_TRY_EXPECT_NO_EXCEPTION(doubleReader->Update());
+
+  ITK_TEST_EXPECT_EQUAL(doubleMeshIO->GetPointComponentType(), itk::IOComponentEnum::DOUBLE);
+  ITK_TEST_EXPECT_EQUAL(doubleReader->GetOutput()->GetNumberOfPoints(), numberOfPoints);
+  for (itk::SizeValueType pointId = 0; pointId < numberOfPoints; ++pointId)
+  {
+    ITK_TEST_EXPECT_EQUAL(doubleReader->GetOutput()->GetPoint(pointId), outputMesh->GetPoint(pointId));
+  }
+
+  //
+  //  Reading through the direct I/O backend gives the same mesh
+  //
+  itk::STLMeshIO::Pointer directMeshIO = itk::STLMeshIO::New();
+  directMeshIO->UseDirectReadOn();
+
+  ReaderType::Pointer directReader = ReaderType::New();
+  directReader->SetFileName(argv[2]);
+  directReader->SetMeshIO(directMeshIO);
+  ITK_TRY_EXPECT_NO_EXCEPTION(directReader->Update());
+
+  ITK_TEST_EXPECT_EQUAL(directReader->GetOutput()->GetNumberOfPoints(), numberOfPoints);
+  ITK_TEST_EXPECT_EQUAL(directReader->GetOutput()->GetNumberOfCells(), numberOfCells);
+
+  //
+  //  ASCII files are written with a period as decimal separator, whatever
+  //  the locale of the process
+  //
+  const std::string localeFileName = std::string(argv[2]) + ".locale.stl";
+  {
+    CommaLocaleGuard commaLocale;
+
+    WriterType::Pointer localeWriter = WriterType::New();
+    localeWriter->SetFileName(localeFileName);
+    localeWriter->SetInput(reader->GetOutput());
+    localeWriter->SetFileTypeAsASCII();
+    ITK_TRY_EXPECT_NO_EXCEPTION(localeWriter->Update());
+  }
+
+  std::ifstream     localeFile(localeFileName);
+  const std::string localeFileContent((std::istreambuf_iterator<char>(localeFile)), std::istreambuf_iterator<char>());
+  ITK_TEST_EXPECT_TRUE(localeFileContent.find(',') == std::string::npos);
+
+  // The coordinates are read back whatever the locale as well, which a
+  // parser of the C locale would truncate at the period, merging points.
+  {
+    CommaLocaleGuard commaLocale;
+
+    ReaderType::Pointer localeReader = ReaderType::New();
+    localeReader->SetFileName(localeFileName);
+    ITK_TRY_EXPECT_NO_EXCEPTION(localeReader->Update());
+
+    ITK_TEST_EXPECT_EQUAL(localeReader->GetOutput()->GetNumberOfPoints(), numberOfPoints);
+    ITK_TEST_EXPECT_EQUAL(localeReader->GetOutput()->GetNumberOfCells(), numberOfCells);
+  }
+
+  //
+  //  Writing to memory gives the content of the file, and reading from
+  //  that memory gives the same mesh
+  //
+  std::ifstream     outputFile(argv[2], std::ios::in | std::ios::binary);
+  std::vector<char> outputFileContent((std::istreambuf_iterator<char>(outputFile)), std::istreambuf_iterator<char>());
+
+  std::vector<char>       outputBuffer;
+  itk::STLMeshIO::Pointer memoryWriterMeshIO = itk::STLMeshIO::New();
+  memoryWriterMeshIO->SetOutputBuffer(&outputBuffer);
+  ITK_TEST_SET_GET_VALUE(&outputBuffer, memoryWriterMeshIO->GetOutputBuffer());
+
+  WriterType::Pointer memoryWriter = WriterType::New();
+  memoryWriter->SetFileName(argv[2]);
+  memoryWriter->SetMeshIO(memoryWriterMeshIO);
+  memoryWriter->SetInput(reader->GetOutput());
+  if (fileMode == 1)
+  {
+    memoryWriter->SetFileTypeAsBINARY();
+  }
+  ITK_TRY_EXPECT_NO_EXCEPTION(memoryWriter->Update());
+
+  ITK_TEST_EXPECT_TRUE(outputBuffer == outputFileContent);
+
+  itk::STLMeshIO::Pointer memoryReaderMeshIO = itk::STLMeshIO::New();
+  memoryReaderMeshIO->SetInputBuffer(outputBuffer.data(), outputBuffer.size());
+  ITK_TEST_SET_GET_VALUE(static_cast<const void *>(outputBuffer.data()), memoryReaderMeshIO->GetInputBuffer());
+  ITK_TEST_SET_GET_VALUE(outputBuffer.size(), memoryReaderMeshIO->GetInputBufferSize());
+
+  ReaderType::Pointer memoryReader = ReaderType::New();
+  memoryReader->SetFileName(argv[2]);
+  memoryReader->SetMeshIO(memoryReaderMeshIO);
+  ITK_TRY_EXPECT_NO_EXCEPTION(memoryReader->Update());
+
+  ITK_TEST_EXPECT_EQUAL(memoryReader->GetOutput()->GetNumberOfPoints(), numberOfPoints);
+  ITK_TEST_EXPECT_EQUAL(memoryReader->GetOutput()->GetNumberOfCells(), numberOfCells);
+
+  //
+  //  Transcoding to the other file type keeps every facet
+  //
+  const std::string       transcodedFileName = std::string(argv[2]) + ".transcoded.stl";
+  itk::STLMeshIO::Pointer transcoderMeshIO = itk::STLMeshIO::New();
+  transcoderMeshIO->SetFileName(argv[2]);
+
+  itk::SizeValueType numberOfFacets = 0;
+  ITK_TRY_EXPECT_NO_EXCEPTION(
+    numberOfFacets = transcoderMeshIO->Transcode(
+      transcodedFileName, fileMode == 1 ? itk::IOFileEnum::ASCII : itk::IOFileEnum::BINARY));
+  ITK_TEST_EXPECT_EQUAL(numberOfFacets, numberOfCells);
+
+  ReaderType::Pointer transcodedReader = ReaderType::New();
+  transcodedReader->SetFileName(transcodedFileName);
+  ITK_TRY_EXPECT_NO_EXCEPTION(transcodedReader->Update());
+
+  ITK_TEST_EXPECT_EQUAL(transcodedReader->GetOutput()->GetNumberOfPoints(), numberOfPoints);
+  ITK_TEST_EXPECT_EQUAL(transcodedReader->GetOutput()->GetNumberOfCells(), numberOfCells);
+
+  //
+  //  Reading only the points gives the same points, and no cell
+  //
+  itk::STLMeshIO::Pointer pointsOnlyMeshIO = itk::STLMeshIO::New();
+  pointsOnlyMeshIO->ReadPointsOnlyOn();
+
+  ReaderType::Pointer pointsOnlyReader = ReaderType::New();
+  pointsOnlyReader->SetFileName(argv[2]);
+  pointsOnlyReader->SetMeshIO(pointsOnlyMeshIO);
+  ITK_TRY_EXPECT_NO_EXCEPTION(pointsOnlyReader->Update());
+
+  ITK_TEST_EXPECT_TRUE(!pointsOnlyMeshIO->GetUpdateCells());
+  ITK_TEST_EXPECT_EQUAL(pointsOnlyReader->GetOutput()->GetNumberOfPoints(), numberOfPoints);
+  ITK_TEST_EXPECT_EQUAL(pointsOnlyReader->GetOutput()->GetNumberOfCells(), 0);
+
+  //
+  //  Welding out of core, with runs small enough to need a merge, gives
+  //  the same number of points and cells
+  //
+  if (fileMode == 1)
+  {
+    itk::STLMeshIO::Pointer externalMeshIO = itk::STLMeshIO::New();
+    externalMeshIO->UseExternalMemoryWeldOn();
+    externalMeshIO->SetWeldMemoryBudget(4096);
+
+    ReaderType::Pointer externalReader = ReaderType::New();
+    externalReader->SetFileName(argv[2]);
+    externalReader->SetMeshIO(externalMeshIO);
+    ITK_TRY_EXPECT_NO_EXCEPTION(externalReader->Update());
+
+    ITK_TEST_EXPECT_EQUAL(externalReader->GetOutput()->GetNumberOfPoints(), numberOfPoints);
+    ITK_TEST_EXPECT_EQUAL(externalReader->GetOutput()->GetNumberOfCells(), numberOfCells);
+  }
+
+  //
+  //  Splitting the output into spatial shards keeps every cell, and writes
+  //  the manifest of the shards
+  //
+  if (fileMode == 1)
+  {
+    itk::STLMeshIO::Pointer shardedMeshIO = itk::STLMeshIO::New();
+    shardedMeshIO->SetNumberOfShards(3);
+    shardedMeshIO->SetShardAxis(2);
+
+    WriterType::Pointer shardedWriter = WriterType::New();
+    shardedWriter->SetFileName(std::string(argv[2]) + ".sharded.stl");
+    shardedWriter->SetMeshIO(shardedMeshIO);
+    shardedWriter->SetInput(reader->GetOutput());
+    shardedWriter->SetFileTypeAsBINARY();
+    ITK_TRY_EXPECT_NO_EXCEPTION(shardedWriter->Update());
+
+    itk::SizeValueType numberOfShardedCells = 0;
+    for (unsigned int shard = 0; shard < shardedMeshIO->GetNumberOfShards(); ++shard)
+    {
+      ReaderType::Pointer shardReader = ReaderType::New();
+      shardReader->SetFileName(shardedMeshIO->GetShardFileName(shard));
+      ITK_TRY_EXPECT_NO_EXCEPTION(shardReader->Update());
+      numberOfShardedCells += shardReader->GetOutput()->GetNumberOfCells();
+    }
+    ITK_TEST_EXPECT_EQUAL(numberOfShardedCells, numberOfCells);
+
+    std::ifstream shardManifest(shardedMeshIO->GetShardManifestFileName());
+    ITK_TEST_EXPECT_TRUE(shardManifest.good());
+  }
+
+  //
+  //  A preview read does not produce more cells than the full read
+  //
+  itk::STLMeshIO::Pointer previewMeshIO = itk::STLMeshIO::New();
+  previewMeshIO->SetPreviewTargetNumberOfTriangles(numberOfCells / 4);
+
+  ReaderType::Pointer previewReader = ReaderType::New();
+  previewReader->SetFileName(argv[2]);
+  previewReader->SetMeshIO(previewMeshIO);
+  ITK_TRY_EXPECT_NO_EXCEPTION(previewReader->Update());
+
+  ITK_TEST_EXPECT_TRUE(previewReader->GetOutput()->GetNumberOfCells() <= numberOfCells);
+
+  //
+  //  The statistics of the unit tetrahedron are its bounds, the area of
+  //  its faces and its volume
+  //
+  TestMeshType::Pointer tetrahedron = MakeTetrahedron();
+  const std::string     tetrahedronFileName = std::string(argv[2]) + ".tetrahedron.stl";
+  ITK_TRY_EXPECT_NO_EXCEPTION(WriteTestMesh(tetrahedron, tetrahedronFileName, itk::STLMeshIO::New()));
+
+  itk::STLMeshIO::Pointer statisticsMeshIO = itk::STLMeshIO::New();
+  statisticsMeshIO->ComputeStatisticsOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(ReadTestMesh(tetrahedronFileName, statisticsMeshIO));
+
+  const itk::MetaDataDictionary & statistics = statisticsMeshIO->GetMetaDataDictionary();
+  std::vector<double>             boundingBox;
+  double                          surfaceArea = 0.0;
+  double                          volume = 0.0;
+  itk::SizeValueType              numberOfDegenerateTriangles = 1;
+  ITK_TEST_EXPECT_TRUE(itk::ExposeMetaData(statistics, "STL_BoundingBox", boundingBox));
+  ITK_TEST_EXPECT_TRUE(itk::ExposeMetaData(statistics, "STL_SurfaceArea", surfaceArea));
+  ITK_TEST_EXPECT_TRUE(itk::ExposeMetaData(statistics, "STL_Volume", volume));
+  ITK_TEST_EXPECT_TRUE(
+    itk::ExposeMetaData(statistics, "STL_NumberOfDegenerateTriangles", numberOfDegenerateTriangles));
+
+  ITK_TEST_EXPECT_TRUE(boundingBox == std::vector<double>({ 0.0, 1.0, 0.0, 1.0, 0.0, 1.0 }));
+  ITK_TEST_EXPECT_TRUE(itk::Math::FloatAlmostEqual(surfaceArea, 1.5 + std::sqrt(3.0) / 2.0, 4, 1e-6));
+  ITK_TEST_EXPECT_TRUE(itk::Math::FloatAlmostEqual(volume, 1.0 / 6.0, 4, 1e-6));
+  ITK_TEST_EXPECT_EQUAL(numberOfDegenerateTriangles, 0);
+
+  //
+  //  Reordering along the Morton curve puts the origin, at the lower corner
+  //  of the bounding box, first, then the points along x, y and z, and the
+  //  triangle away from the origin last; the points are otherwise numbered
+  //  in the order of their first appearance in the file
+  //
+  TestMeshType::Pointer fileOrderTetrahedron;
+  ITK_TRY_EXPECT_NO_EXCEPTION(fileOrderTetrahedron = ReadTestMesh(tetrahedronFileName, itk::STLMeshIO::New()));
+
+  itk::STLMeshIO::Pointer reorderedMeshIO = itk::STLMeshIO::New();
+  reorderedMeshIO->ReorderForLocalityOn();
+  TestMeshType::Pointer reorderedTetrahedron;
+  ITK_TRY_EXPECT_NO_EXCEPTION(reorderedTetrahedron = ReadTestMesh(tetrahedronFileName, reorderedMeshIO));
+
+  ITK_TEST_EXPECT_EQUAL(reorderedTetrahedron->GetNumberOfPoints(), 4);
+  ITK_TEST_EXPECT_EQUAL(reorderedTetrahedron->GetNumberOfCells(), 4);
+  for (unsigned int pointId = 0; pointId < 4; ++pointId)
+  {
+    ITK_TEST_EXPECT_EQUAL(fileOrderTetrahedron->GetPoint(pointId), tetrahedron->GetPoint((pointId + 1) % 4));
+    ITK_TEST_EXPECT_EQUAL(reorderedTetrahedron->GetPoint(pointId), tetrahedron->GetPoint(pointId));
+  }
+
+  const TestMeshType::PointIdentifier reorderedTriangles[4][3] = { { 0, 2, 1 }, { 0, 1, 3 }, { 0, 3, 2 }, { 1, 2, 3 } };
+  for (unsigned int cellId = 0; cellId < 4; ++cellId)
+  {
+    TestMeshType::CellAutoPointer cell;
+    ITK_TEST_EXPECT_TRUE(reorderedTetrahedron->GetCell(cellId, cell));
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+      ITK_TEST_EXPECT_EQUAL(cell->GetPointIds()[k], reorderedTriangles[cellId][k]);
+    }
+  }
+
+  //
+  //  A region of interest beyond x = 0.6 keeps the three triangles that
+  //  touch the point at 1 along x, but not the face in the plane x = 0
+  //
+  itk::STLMeshIO::BoundsType tetrahedronRegion;
+  tetrahedronRegion[0] = 0.6;
+  tetrahedronRegion[1] = 2.0;
+  tetrahedronRegion[2] = -1.0;
+  tetrahedronRegion[3] = 2.0;
+  tetrahedronRegion[4] = -1.0;
+  tetrahedronRegion[5] = 2.0;
+
+  itk::STLMeshIO::Pointer regionMeshIO = itk::STLMeshIO::New();
+  regionMeshIO->UseRegionOfInterestOn();
+  regionMeshIO->SetRegionOfInterest(tetrahedronRegion);
+  TestMeshType::Pointer regionTetrahedron;
+  ITK_TRY_EXPECT_NO_EXCEPTION(regionTetrahedron = ReadTestMesh(tetrahedronFileName, regionMeshIO));
+
+  ITK_TEST_EXPECT_EQUAL(regionTetrahedron->GetNumberOfPoints(), 4);
+  ITK_TEST_EXPECT_EQUAL(regionTetrahedron->GetNumberOfCells(), 3);
+
+  //
+  //  The first region read with the spatial index builds the .stlidx file
+  //  next to the STL file, and the reads that query it keep the same
+  //  triangles
+  //
+  const std::string indexFileName = std::string(argv[2]) + ".tetrahedron.stlidx";
+  std::remove(indexFileName.c_str());
+
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    itk::STLMeshIO::Pointer indexedMeshIO = itk::STLMeshIO::New();
+    indexedMeshIO->UseRegionOfInterestOn();
+    indexedMeshIO->SetRegionOfInterest(tetrahedronRegion);
+    indexedMeshIO->UseSpatialIndexOn();
+    TestMeshType::Pointer indexedTetrahedron;
+    ITK_TRY_EXPECT_NO_EXCEPTION(indexedTetrahedron = ReadTestMesh(tetrahedronFileName, indexedMeshIO));
+
+    ITK_TEST_EXPECT_TRUE(std::ifstream(indexFileName).good());
+    ITK_TEST_EXPECT_EQUAL(indexedTetrahedron->GetNumberOfPoints(), 4);
+    ITK_TEST_EXPECT_EQUAL(indexedTetrahedron->GetNumberOfCells(), 3);
+  }
+
+  //
+  //  Appending a copy of the tetrahedron, moved along x, to a file that
+  //  holds the tetrahedron keeps the triangles of both
+  //
+  TestMeshType::Pointer movedTetrahedron = MakeTetrahedron();
+  for (TestMeshType::PointIdentifier pointId = 0; pointId < 4; ++pointId)
+  {
+    TestMeshType::PointType point = movedTetrahedron->GetPoint(pointId);
+    point[0] += 2.0;
+    movedTetrahedron->SetPoint(pointId, point);
+  }
+
+  const std::string appendedFileName = std::string(argv[2]) + ".appended.stl";
+  std::remove(appendedFileName.c_str());
+
+  for (TestMeshType * appendedMesh : { tetrahedron.GetPointer(), movedTetrahedron.GetPointer() })
+  {
+    itk::STLMeshIO::Pointer appendMeshIO = itk::STLMeshIO::New();
+    appendMeshIO->AppendToFileOn();
+    ITK_TRY_EXPECT_NO_EXCEPTION(WriteTestMesh(appendedMesh, appendedFileName, appendMeshIO));
+  }
+
+  TestMeshType::Pointer appendedTetrahedra;
+  ITK_TRY_EXPECT_NO_EXCEPTION(appendedTetrahedra = ReadTestMesh(appendedFileName, itk::STLMeshIO::New()));
+
+  ITK_TEST_EXPECT_EQUAL(appendedTetrahedra->GetNumberOfPoints(), 8);
+  ITK_TEST_EXPECT_EQUAL(appendedTetrahedra->GetNumberOfCells(), 8);
+  ITK_TEST_EXPECT_EQUAL(appendedTetrahedra->GetPoint(4), movedTetrahedron->GetPoint(1));
+
+  //
+  //  The first read with the welded mesh cache writes the .stlcache file,
+  //  and the next one loads the same mesh from it
+  //
+  const std::string cacheFileName = std::string(argv[2]) + ".tetrahedron.stlcache";
+  std::remove(cacheFileName.c_str());
+
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    itk::STLMeshIO::Pointer cachedMeshIO = itk::STLMeshIO::New();
+    cachedMeshIO->UseWeldedMeshCacheOn();
+    TestMeshType::Pointer cachedTetrahedron;
+    ITK_TRY_EXPECT_NO_EXCEPTION(cachedTetrahedron = ReadTestMesh(tetrahedronFileName, cachedMeshIO));
+
+    ITK_TEST_EXPECT_EQUAL(cachedMeshIO->GetReadFromWeldedMeshCache(), i == 1);
+    ITK_TEST_EXPECT_TRUE(std::ifstream(cacheFileName).good());
+    ITK_TEST_EXPECT_EQUAL(cachedTetrahedron->GetNumberOfPoints(), 4);
+    ITK_TEST_EXPECT_EQUAL(cachedTetrahedron->GetNumberOfCells(), 4);
+    for (unsigned int pointId = 0; pointId < 4; ++pointId)
+    {
+      ITK_TEST_EXPECT_EQUAL(cachedTetrahedron->GetPoint(pointId), fileOrderTetrahedron->GetPoint(pointId));
+    }
+  }
+
+  //
+  //  With TriangulatePolygons, a quadrilateral and a pentagon are written as
+  //  fans of 2 and 3 triangles around their first point; without it, they
+  //  cannot be written
+  //
+  using QuadrilateralCellType = itk::QuadrilateralCell<TestMeshType::CellType>;
+  using PolygonCellType = itk::PolygonCell<TestMeshType::CellType>;
+
+  TestMeshType::Pointer polygons = TestMeshType::New();
+  const float           polygonPoints[9][2] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f },
+                                                { 0.0f, 1.0f }, { 2.0f, 0.0f }, { 3.0f, 0.0f },
+                                                { 3.0f, 1.0f }, { 2.5f, 2.0f }, { 2.0f, 1.0f } };
+  for (TestMeshType::PointIdentifier pointId = 0; pointId < 9; ++pointId)
+  {
+    TestMeshType::PointType point;
+    point[0] = polygonPoints[pointId][0];
+    point[1] = polygonPoints[pointId][1];
+    point[2] = 0.0f;
+    polygons->SetPoint(pointId, point);
+  }
+
+  TestMeshType::CellAutoPointer quadrilateral;
+  quadrilateral.TakeOwnership(new QuadrilateralCellType);
+  for (TestMeshType::PointIdentifier pointId = 0; pointId < 4; ++pointId)
+  {
+    quadrilateral->SetPointId(pointId, pointId);
+  }
+  polygons->SetCell(0, quadrilateral);
+
+  auto * pentagonCell = new PolygonCellType;
+  for (TestMeshType::PointIdentifier pointId = 4; pointId < 9; ++pointId)
+  {
+    pentagonCell->AddPointId(pointId);
+  }
+  TestMeshType::CellAutoPointer pentagon;
+  pentagon.TakeOwnership(pentagonCell);
+  polygons->SetCell(1, pentagon);
+
+  const std::string polygonsFileName = std::string(argv[2]) + ".polygons.stl";
+  ITK_TRY_EXPECT_EXCEPTION(WriteTestMesh(polygons, polygonsFileName, itk::STLMeshIO::New()));
+
+  itk::STLMeshIO::Pointer triangulatingMeshIO = itk::STLMeshIO::New();
+  triangulatingMeshIO->TriangulatePolygonsOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(WriteTestMesh(polygons, polygonsFileName, triangulatingMeshIO));
+
+  TestMeshType::Pointer triangulatedPolygons;
+  ITK_TRY_EXPECT_NO_EXCEPTION(triangulatedPolygons = ReadTestMesh(polygonsFileName, itk::STLMeshIO::New()));
+
+  ITK_TEST_EXPECT_EQUAL(triangulatedPolygons->GetNumberOfPoints(), 9);
+  ITK_TEST_EXPECT_EQUAL(triangulatedPolygons->GetNumberOfCells(), 5);
+  for (TestMeshType::PointIdentifier pointId = 0; pointId < 9; ++pointId)
+  {
+    ITK_TEST_EXPECT_EQUAL(triangulatedPolygons->GetPoint(pointId), polygons->GetPoint(pointId));
+  }
+
+  const TestMeshType::PointIdentifier fanTriangles[5][3] = { { 0, 1, 2 }, { 0, 2, 3 }, { 4, 5, 6 },
+                                                             { 4, 6, 7 }, { 4, 7, 8 } };
+  for (unsigned int cellId = 0; cellId < 5; ++cellId)
+  {
+    TestMeshType::CellAutoPointer cell;
+    ITK_TEST_EXPECT_TRUE(triangulatedPolygons->GetCell(cellId, cell));
+    for (unsigned int k = 0; k < 3; ++k)
+    {
+      ITK_TEST_EXPECT_EQUAL(cell->GetPointIds()[k], fanTriangles[cellId][k]);
+    }
+  }
+
+  //
+  //  A triangle with a repeated point and a copy of a face with the
+  //  opposite orientation are dropped on request, and counted
+  //
+  TestMeshType::Pointer defectiveTetrahedron = MakeTetrahedron();
+  AddTriangle(defectiveTetrahedron, 0, 3, 3);
+  AddTriangle(defectiveTetrahedron, 0, 2, 3);
+
+  const std::string defectiveFileName = std::string(argv[2]) + ".defective.stl";
+  ITK_TRY_EXPECT_NO_EXCEPTION(WriteTestMesh(defectiveTetrahedron, defectiveFileName, itk::STLMeshIO::New()));
+
+  TestMeshType::Pointer defectiveMesh;
+  ITK_TRY_EXPECT_NO_EXCEPTION(defectiveMesh = ReadTestMesh(defectiveFileName, itk::STLMeshIO::New()));
+  ITK_TEST_EXPECT_EQUAL(defectiveMesh->GetNumberOfCells(), 6);
+
+  itk::STLMeshIO::Pointer cleaningMeshIO = itk::STLMeshIO::New();
+  cleaningMeshIO->RemoveDegenerateTrianglesOn();
+  cleaningMeshIO->RemoveDuplicateTrianglesOn();
+  TestMeshType::Pointer cleanedMesh;
+  ITK_TRY_EXPECT_NO_EXCEPTION(cleanedMesh = ReadTestMesh(defectiveFileName, cleaningMeshIO));
+
+  ITK_TEST_EXPECT_EQUAL(cleanedMesh->GetNumberOfPoints(), 4);
+  ITK_TEST_EXPECT_EQUAL(cleanedMesh->GetNumberOfCells(), 4);
+
+  const itk::MetaDataDictionary & cleaning = cleaningMeshIO->GetMetaDataDictionary();
+  itk::SizeValueType              numberOfRemovedDegenerateTriangles = 0;
+  itk::SizeValueType              numberOfRemovedDuplicateTriangles = 0;
+  ITK_TEST_EXPECT_TRUE(
+    itk::ExposeMetaData(cleaning, "STL_NumberOfRemovedDegenerateTriangles", numberOfRemovedDegenerateTriangles));
+  ITK_TEST_EXPECT_TRUE(
+    itk::ExposeMetaData(cleaning, "STL_NumberOfRemovedDuplicateTriangles", numberOfRemovedDuplicateTriangles));
+  ITK_TEST_EXPECT_EQUAL(numberOfRemovedDegenerateTriangles, 1);
+  ITK_TEST_EXPECT_EQUAL(numberOfRemovedDuplicateTriangles, 1);
+
+  //
+  //  A preview read on a fine grid drops the collapsed and the repeated
+  //  triangles, and counts the repeated ones
+  //
+  itk::STLMeshIO::Pointer previewCleaningMeshIO = itk::STLMeshIO::New();
+  previewCleaningMeshIO->SetPreviewCellSize(0.01);
+  previewCleaningMeshIO->RemoveDuplicateTrianglesOn();
+  TestMeshType::Pointer previewCleanedMesh;
+  ITK_TRY_EXPECT_NO_EXCEPTION(previewCleanedMesh = ReadTestMesh(defectiveFileName, previewCleaningMeshIO));
+
+  ITK_TEST_EXPECT_EQUAL(previewCleanedMesh->GetNumberOfPoints(), 4);
+  ITK_TEST_EXPECT_EQUAL(previewCleanedMesh->GetNumberOfCells(), 4);
+
+  numberOfRemovedDuplicateTriangles = 0;
+  ITK_TEST_EXPECT_TRUE(itk::ExposeMetaData(previewCleaningMeshIO->GetMetaDataDictionary(),
+                                           "STL_NumberOfRemovedDuplicateTriangles",
+                                           numberOfRemovedDuplicateTriangles));
+  ITK_TEST_EXPECT_EQUAL(numberOfRemovedDuplicateTriangles, 1);
+
+  //
+  //  Far from the origin, the cells of the preview grid are told apart
+  //  even where their coordinates do not fit in a float: the x coordinates
+  //  1e6 and 1e6 + 0.0625 fall in the cells 20000000 and 20000001
+  //
+  const float farCoordinates[3][3] = { { 1e6f, 0.0f, 0.0f }, { 1e6f + 0.0625f, 0.0f, 0.0f }, { 1e6f, 1.0f, 0.0f } };
+
+  TestMeshType::Pointer farTriangle = TestMeshType::New();
+  for (unsigned int k = 0; k < 3; ++k)
+  {
+    farTriangle->SetPoint(k, TestMeshType::PointType(farCoordinates[k]));
+  }
+  AddTriangle(farTriangle, 0, 1, 2);
+
+  const std::string farFileName = std::string(argv[2]) + ".far.stl";
+  ITK_TRY_EXPECT_NO_EXCEPTION(WriteTestMesh(farTriangle, farFileName, itk::STLMeshIO::New()));
+
+  itk::STLMeshIO::Pointer farPreviewMeshIO = itk::STLMeshIO::New();
+  farPreviewMeshIO->SetPreviewCellSize(0.05);
+  TestMeshType::Pointer farPreview;
+  ITK_TRY_EXPECT_NO_EXCEPTION(farPreview = ReadTestMesh(farFileName, farPreviewMeshIO));
+
+  ITK_TEST_EXPECT_EQUAL(farPreview->GetNumberOfPoints(), 3);
+  ITK_TEST_EXPECT_EQUAL(farPreview->GetNumberOfCells(), 1);
+
+  //
+  //  A mesh without cells, for which MeshFileWriter does not call
+  //  WriteCells(), is written as a binary file without triangles, also
+  //  through the memory mapping
+  //
+  TestMeshType::Pointer pointsOnlyMesh = TestMeshType::New();
+  pointsOnlyMesh->SetPoint(0, tetrahedron->GetPoint(0));
+
+  const std::string emptyFileName = std::string(argv[2]) + ".empty.stl";
+  for (const bool useMemoryMappedWriter : { false, true })
+  {
+    std::remove(emptyFileName.c_str());
+
+    itk::STLMeshIO::Pointer emptyMeshIO = itk::STLMeshIO::New();
+    emptyMeshIO->SetUseMemoryMappedWriter(useMemoryMappedWriter);
+    ITK_TRY_EXPECT_NO_EXCEPTION(WriteTestMesh(pointsOnlyMesh, emptyFileName, emptyMeshIO));
+
+    ITK_TEST_EXPECT_EQUAL(itksys::SystemTools::FileLength(emptyFileName), 84);
+
+    TestMeshType::Pointer emptyMesh;
+    ITK_TRY_EXPECT_NO_EXCEPTION(emptyMesh = ReadTestMesh(emptyFileName, itk::STLMeshIO::New()));
+    ITK_TEST_EXPECT_EQUAL(emptyMesh->GetNumberOfCells(), 0);
+  }
+
+  //
+  //  An instance that welded a mesh of its own and then loads the cached
+  //  empty mesh returns none of the points and triangles of the earlier one
+  //
+  const std::string emptyCacheFileName = std::string(argv[2]) + ".empty.stlcache";
+  std::remove(emptyCacheFileName.c_str());
+  std::remove(cacheFileName.c_str());
+
+  itk::STLMeshIO::Pointer cachedReusedMeshIO = itk::STLMeshIO::New();
+  cachedReusedMeshIO->UseWeldedMeshCacheOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(ReadTestMesh(emptyFileName, cachedReusedMeshIO));
+  ITK_TRY_EXPECT_NO_EXCEPTION(ReadTestMesh(tetrahedronFileName, cachedReusedMeshIO));
+  ITK_TEST_EXPECT_TRUE(!cachedReusedMeshIO->GetReadFromWeldedMeshCache());
+
+  TestMeshType::Pointer cachedEmptyMesh;
+  ITK_TRY_EXPECT_NO_EXCEPTION(cachedEmptyMesh = ReadTestMesh(emptyFileName, cachedReusedMeshIO));
+  ITK_TEST_EXPECT_TRUE(cachedReusedMeshIO->GetReadFromWeldedMeshCache());
+  ITK_TEST_EXPECT_EQUAL(cachedEmptyMesh->GetNumberOfPoints(), 0);
+  ITK_TEST_EXPECT_EQUAL(cachedEmptyMesh->GetNumberOfCells(), 0);
+
+  //
+  //  Without cells, the shards are written without triangles, and their
+  //  manifest keeps a period as decimal separator whatever the locale
+  //
+  itk::STLMeshIO::Pointer emptyShardedMeshIO = itk::STLMeshIO::New();
+  emptyShardedMeshIO->SetNumberOfShards(2);
+  {
+    CommaLocaleGuard commaLocale;
+    ITK_TRY_EXPECT_NO_EXCEPTION(WriteTestMesh(pointsOnlyMesh, emptyFileName, emptyShardedMeshIO));
+  }
+
+  for (unsigned int shard = 0; shard < emptyShardedMeshIO->GetNumberOfShards(); ++shard)
+  {
+    ITK_TEST_EXPECT_EQUAL(itksys::SystemTools::FileLength(emptyShardedMeshIO->GetShardFileName(shard)), 84);
+  }
+
+  std::ifstream     emptyShardManifest(emptyShardedMeshIO->GetShardManifestFileName());
+  const std::string emptyShardManifestContent((std::istreambuf_iterator<char>(emptyShardManifest)),
+                                              std::istreambuf_iterator<char>());
+  ITK_TEST_EXPECT_TRUE(emptyShardManifestContent.find("triangles 0\n") != std::string::npos);
+  ITK_TEST_EXPECT_TRUE(emptyShardManifestContent.find(',') == std::string::npos);
+
+  //
+  //  The point Ids of the triangles are stored in 32 bits, and widened once
+  //  an Id does not fit: the Ids read back are those stored, before and
+  //  after the widening, and in the wide storage set by resize()
+  //
+  using CellsVectorType = CellsVectorTestMeshIO::CellsVectorType;
+  using TripletType = CellsVectorTestMeshIO::TripletType;
+
+  const auto sameTriangle = [](const TripletType & triangle, const TripletType & expected) {
+    return triangle.p0 == expected.p0 && triangle.p1 == expected.p1 && triangle.p2 == expected.p2;
+  };
+
+  CellsVectorType narrowCells;
+  narrowCells.push_back({ 0, 1, 2 });
+  ITK_TEST_EXPECT_TRUE(!narrowCells.IsWide());
+  ITK_TEST_EXPECT_TRUE(sameTriangle(narrowCells[0], { 0, 1, 2 }));
+
+  if (sizeof(itk::IdentifierType) > sizeof(uint32_t))
+  {
+    const itk::IdentifierType largeId = itk::IdentifierType{ std::numeric_limits<uint32_t>::max() } + 1;
+    narrowCells.push_back({ 3, largeId, largeId + 1 });
+    narrowCells.push_back({ 4, 5, 6 });
+
+    ITK_TEST_EXPECT_TRUE(narrowCells.IsWide());
+    ITK_TEST_EXPECT_EQUAL(narrowCells.size(), 3);
+    ITK_TEST_EXPECT_TRUE(sameTriangle(narrowCells[0], { 0, 1, 2 }));
+    ITK_TEST_EXPECT_TRUE(sameTriangle(narrowCells[1], { 3, largeId, largeId + 1 }));
+    ITK_TEST_EXPECT_TRUE(sameTriangle(narrowCells[2], { 4, 5, 6 }));
+  }
+
+  CellsVectorType wideCells;
+  wideCells.resize(2, true);
+  wideCells.SetTriangle(0, { 7, 8, 9 });
+  wideCells.SetTriangle(1, { 10, 11, 12 });
+  wideCells.push_back({ 13, 14, 15 });
+
+  ITK_TEST_EXPECT_TRUE(wideCells.IsWide());
+  ITK_TEST_EXPECT_EQUAL(wideCells.size(), 3);
+  ITK_TEST_EXPECT_TRUE(sameTriangle(wideCells[0], { 7, 8, 9 }));
+  ITK_TEST_EXPECT_TRUE(sameTriangle(wideCells[1], { 10, 11, 12 }));
+  ITK_TEST_EXPECT_TRUE(sameTriangle(wideCells[2], { 13, 14, 15 }));
+
+  wideCells.clear();
+  ITK_TEST_EXPECT_TRUE(!wideCells.IsWide());
+  ITK_TEST_EXPECT_EQUAL(wideCells.size(), 0);
+
 
   //
   //  Exercising additional methods
@@ -76,6 +877,76 @@ itkSTLMeshIOTest(int argc, char * argv[])
 
   ITK_EXERCISE_BASIC_OBJECT_METHODS(meshIO, STLMeshIO, MeshIOBase);
 
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, TriangulatePolygons, false);
+
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, AppendToFile, false);
+
+  const unsigned int numberOfShards = 4;
+  meshIO->SetNumberOfShards(numberOfShards);
+  ITK_TEST_SET_GET_VALUE(numberOfShards, meshIO->GetNumberOfShards());
+
+  const int shardAxis = 1;
+  meshIO->SetShardAxis(shardAxis);
+  ITK_TEST_SET_GET_VALUE(shardAxis, meshIO->GetShardAxis());
+
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, UseMemoryMappedWriter, false);
+
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, UseBackgroundWriter, false);
+
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, DeferParsing, false);
+
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, ReadPointsOnly, false);
+
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, UseDirectRead, false);
+
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, ComputeStatistics, false);
+
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, ReorderForLocality, false);
+
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, ComputeEdgeAdjacency, false);
+
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, RemoveDegenerateTriangles, false);
+
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, RemoveDuplicateTriangles, false);
+
+  const double degenerateAreaThreshold = 1e-6;
+  meshIO->SetDegenerateAreaThreshold(degenerateAreaThreshold);
+  ITK_TEST_SET_GET_VALUE(degenerateAreaThreshold, meshIO->GetDegenerateAreaThreshold());
+
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, UseRegionOfInterest, false);
+
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, UseSpatialIndex, false);
+
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, UseWeldedMeshCache, false);
+
+  ITK_TEST_SET_GET_BOOLEAN(meshIO, UseExternalMemoryWeld, false);
+
+  const itk::SizeValueType weldMemoryBudget = 1 << 20;
+  meshIO->SetWeldMemoryBudget(weldMemoryBudget);
+  ITK_TEST_SET_GET_VALUE(weldMemoryBudget, meshIO->GetWeldMemoryBudget());
+
+  const std::string scratchDirectory = ".";
+  meshIO->SetScratchDirectory(scratchDirectory);
+  ITK_TEST_SET_GET_VALUE(scratchDirectory, std::string(meshIO->GetScratchDirectory()));
+
+  const double previewCellSize = 0.5;
+  meshIO->SetPreviewCellSize(previewCellSize);
+  ITK_TEST_SET_GET_VALUE(previewCellSize, meshIO->GetPreviewCellSize());
+
+  const itk::SizeValueType previewTargetNumberOfTriangles = 1000;
+  meshIO->SetPreviewTargetNumberOfTriangles(previewTargetNumberOfTriangles);
+  ITK_TEST_SET_GET_VALUE(previewTargetNumberOfTriangles, meshIO->GetPreviewTargetNumberOfTriangles());
+
+  itk::STLMeshIO::BoundsType regionOfInterest;
+  regionOfInterest[0] = -1.0;
+  regionOfInterest[1] = 1.0;
+  regionOfInterest[2] = -2.0;
+  regionOfInterest[3] = 2.0;
+  regionOfInterest[4] = -3.0;
+  regionOfInterest[5] = 3.0;
+  meshIO->SetRegionOfInterest(regionOfInterest);
+  ITK_TEST_SET_GET_VALUE(regionOfInterest, meshIO->GetRegionOfInterest());
+
   mesh->Print(std::cout);
   reader->GetMeshIO()->Print(std::cout);
   writer->GetMeshIO()->Print(std::cout);
@@ -0,0 +1,123 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkMeshFileReader.h"
+#include "itkMetaDataObject.h"
+#include "itkQuadEdgeMesh.h"
+#include "itkSTLMeshIO.h"
+#include "itkSTLQuadEdgeMeshReader.h"
+#include "itkTestingMacros.h"
+
+int
+itkSTLQuadEdgeMeshReaderTest(int argc, char * argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Missing Arguments." << std::endl;
+    std::cerr << "Usage: " << std::endl;
+    std::cerr << "inputMesh" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  constexpr unsigned int Dimension = 3;
+  using PixelType = float;
+
+  using QEMeshType = itk::QuadEdgeMesh<PixelType, Dimension>;
+
+  using ReaderType = itk::STLQuadEdgeMeshReader<QEMeshType>;
+
+  ReaderType::Pointer reader = ReaderType::New();
+
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(reader, STLQuadEdgeMeshReader, Object);
+
+  itk::STLMeshIO::Pointer meshIO = itk::STLMeshIO::New();
+
+  reader->SetFileName(argv[1]);
+  reader->SetMeshIO(meshIO);
+
+  ITK_TRY_EXPECT_NO_EXCEPTION(reader->Update());
+
+  // The reader does not change the options of the MeshIO of the caller.
+  ITK_TEST_EXPECT_TRUE(!meshIO->GetComputeEdgeAdjacency());
+
+  //
+  // The adjacency computed by the STLMeshIO pairs the half-edges of the
+  // shared edges in both directions.
+  //
+  const itk::STLMeshIO::HalfEdgeNeighborsType & neighbors = meshIO->GetHalfEdgeNeighbors();
+  ITK_TEST_EXPECT_EQUAL(neighbors.size(), 3 * meshIO->GetNumberOfCells());
+
+  for (itk::SizeValueType h = 0; h < neighbors.size(); ++h)
+  {
+    if (neighbors[h] < itk::STLMeshIO::NonManifoldHalfEdge)
+    {
+      ITK_TEST_EXPECT_EQUAL(neighbors[neighbors[h]], h);
+    }
+  }
+
+  itk::SizeValueType numberOfNonManifoldEdges = 0;
+  ITK_TEST_EXPECT_TRUE(
+    itk::ExposeMetaData(meshIO->GetMetaDataDictionary(), "STL_NumberOfNonManifoldEdges", numberOfNonManifoldEdges));
+  ITK_TEST_EXPECT_EQUAL(numberOfNonManifoldEdges, 0);
+
+  //
+  // The mesh matches the one built cell by cell by the MeshFileReader.
+  //
+  using MeshFileReaderType = itk::MeshFileReader<QEMeshType>;
+  MeshFileReaderType::Pointer meshFileReader = MeshFileReaderType::New();
+  meshFileReader->SetFileName(argv[1]);
+  ITK_TRY_EXPECT_NO_EXCEPTION(meshFileReader->Update());
+
+  const QEMeshType * mesh = reader->GetOutput();
+
+  ITK_TEST_EXPECT_EQUAL(reader->GetNumberOfRejectedTriangles(), 0);
+  ITK_TEST_EXPECT_EQUAL(mesh->GetNumberOfPoints(), meshFileReader->GetOutput()->GetNumberOfPoints());
+  ITK_TEST_EXPECT_EQUAL(mesh->GetNumberOfFaces(), meshFileReader->GetOutput()->GetNumberOfFaces());
+  ITK_TEST_EXPECT_EQUAL(mesh->GetNumberOfEdges(), meshFileReader->GetOutput()->GetNumberOfEdges());
+
+  //
+  // A MeshIO set to read DOUBLE coordinates fills a mesh of double
+  // coordinates with the same points.
+  //
+  using DoubleQEMeshType =
+    itk::QuadEdgeMesh<PixelType, Dimension, itk::QuadEdgeMeshTraits<PixelType, Dimension, bool, bool, double>>;
+  using DoubleReaderType = itk::STLQuadEdgeMeshReader<DoubleQEMeshType>;
+
+  itk::STLMeshIO::Pointer doubleMeshIO = itk::STLMeshIO::New();
+  doubleMeshIO->SetPointComponentType(itk::IOComponentEnum::DOUBLE);
+
+  DoubleReaderType::Pointer doubleReader = DoubleReaderType::New();
+  doubleReader->SetFileName(argv[1]);
+  doubleReader->SetMeshIO(doubleMeshIO);
+  ITK_TRY_EXPECT_NO_EXCEPTION(doubleReader->Update());
+
+  const DoubleQEMeshType * doubleMesh = doubleReader->GetOutput();
+
+  ITK_TEST_EXPECT_EQUAL(doubleMesh->GetNumberOfPoints(), mesh->GetNumberOfPoints());
+  ITK_TEST_EXPECT_EQUAL(doubleMesh->GetNumberOfFaces(), mesh->GetNumberOfFaces());
+  for (QEMeshType::PointIdentifier pointId = 0; pointId < mesh->GetNumberOfPoints(); ++pointId)
+  {
+    for (unsigned int i = 0; i < Dimension; ++i)
+    {
+      ITK_TEST_EXPECT_EQUAL(doubleMesh->GetPoint(pointId)[i], mesh->GetPoint(pointId)[i]);
+    }
+  }
+
+  std::cout << "Test finished." << std::endl;
+  return EXIT_SUCCESS;
+}
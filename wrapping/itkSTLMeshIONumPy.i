@@ -0,0 +1,186 @@
+// NumPy access to the points and triangles of STL files.
+//
+// The arrays are allocated by NumPy and filled, or read, in place by
+// STLMeshIO through the Python buffer protocol: no element is copied
+// through Python.
+
+%{
+namespace
+{
+// Contiguous view of a Python object exposing the buffer protocol.
+class STLMeshIOBufferView
+{
+public:
+  STLMeshIOBufferView(PyObject * object, bool writable)
+  {
+    const int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0);
+    if (PyObject_GetBuffer(object, &m_View, flags) != 0)
+    {
+      PyErr_Clear();
+      throw std::invalid_argument("Expected a C-contiguous array");
+    }
+  }
+
+  ~STLMeshIOBufferView() { PyBuffer_Release(&m_View); }
+
+  STLMeshIOBufferView(const STLMeshIOBufferView &) = delete;
+  STLMeshIOBufferView &
+  operator=(const STLMeshIOBufferView &) = delete;
+
+  void *
+  Data() const
+  {
+    return m_View.buf;
+  }
+
+  Py_ssize_t
+  ItemSize() const
+  {
+    return m_View.itemsize;
+  }
+
+  Py_ssize_t
+  NumberOfItems() const
+  {
+    return m_View.len / m_View.itemsize;
+  }
+
+private:
+  Py_buffer m_View;
+};
+
+itk::IOComponentEnum
+STLMeshIOTriangleComponentType(const STLMeshIOBufferView & view)
+{
+  switch (view.ItemSize())
+  {
+    case 4:
+      return itk::IOComponentEnum::UINT;
+    case 8:
+      return itk::IOComponentEnum::ULONGLONG;
+    default:
+      throw std::invalid_argument("Triangles must be of type uint32 or uint64");
+  }
+}
+} // namespace
+%}
+
+%extend itkSTLMeshIO {
+  const char * _GetPointDType()
+  {
+    return $self->GetPointComponentType() == itk::IOComponentEnum::DOUBLE ? "float64" : "float32";
+  }
+
+  void _ReadPointsArray(PyObject * points)
+  {
+    const STLMeshIOBufferView pointsView(points, true);
+
+    const size_t pointItemSize =
+      $self->GetPointComponentType() == itk::IOComponentEnum::DOUBLE ? sizeof(double) : sizeof(float);
+
+    if (pointsView.ItemSize() != pointItemSize ||
+        pointsView.NumberOfItems() != static_cast<Py_ssize_t>(3 * $self->GetNumberOfPoints()))
+    {
+      throw std::invalid_argument("Points array does not match the size of the mesh");
+    }
+
+    $self->ReadPoints(pointsView.Data());
+  }
+
+  void _ReadTrianglesArray(PyObject * triangles)
+  {
+    const STLMeshIOBufferView trianglesView(triangles, true);
+
+    if (trianglesView.NumberOfItems() != static_cast<Py_ssize_t>(3 * $self->GetNumberOfCells()))
+    {
+      throw std::invalid_argument("Triangles array does not match the size of the mesh");
+    }
+
+    $self->ReadTriangles(trianglesView.Data(), STLMeshIOTriangleComponentType(trianglesView));
+  }
+
+  void _WriteArrays(PyObject * points, PyObject * triangles)
+  {
+    const STLMeshIOBufferView pointsView(points, false);
+    const STLMeshIOBufferView trianglesView(triangles, false);
+
+    if (pointsView.ItemSize() != sizeof(float))
+    {
+      throw std::invalid_argument("Points must be of type float32");
+    }
+
+    $self->SetPointDimension(3);
+    $self->SetPointComponentType(itk::IOComponentEnum::FLOAT);
+    $self->SetNumberOfPoints(pointsView.NumberOfItems() / 3);
+    $self->SetNumberOfCells(trianglesView.NumberOfItems() / 3);
+
+    $self->WriteMeshInformation();
+    $self->WritePoints(pointsView.Data());
+    $self->WriteTriangles(trianglesView.Data(), STLMeshIOTriangleComponentType(trianglesView));
+    $self->Write();
+  }
+
+  %pythoncode %{
+    @staticmethod
+    def read_arrays(file_name, index_dtype="uint32", mesh_io=None):
+        """Read an STL file into NumPy arrays.
+
+        Returns a tuple (points, triangles) with the (N, 3) coordinates of
+        the unique points and the (M, 3) point ids of the triangles, of type
+        index_dtype: uint32 or uint64. The coordinates are float32, or
+        float64 when mesh_io reads DOUBLE point components. A configured
+        STLMeshIO can be passed as mesh_io to use its reading options.
+        """
+        import numpy as np
+
+        index_dtype = np.dtype(index_dtype)
+        if index_dtype not in (np.dtype(np.uint32), np.dtype(np.uint64)):
+            raise ValueError("index_dtype must be uint32 or uint64")
+
+        if mesh_io is None:
+            mesh_io = itkSTLMeshIO.New()
+        mesh_io.SetFileName(str(file_name))
+        mesh_io.ReadMeshInformation()
+
+        # With DeferParsing, the number of points is an upper bound until
+        # ReadPoints() decodes the triangles; the points array is then
+        # shrunk in place, and the triangles array is only allocated once
+        # the number of cells is exact.
+        points = np.empty((mesh_io.GetNumberOfPoints(), 3), dtype=mesh_io._GetPointDType())
+        mesh_io._ReadPointsArray(points)
+        if len(points) != mesh_io.GetNumberOfPoints():
+            points.resize((mesh_io.GetNumberOfPoints(), 3), refcheck=False)
+
+        triangles = np.empty((mesh_io.GetNumberOfCells(), 3), dtype=index_dtype)
+        mesh_io._ReadTrianglesArray(triangles)
+        return points, triangles
+
+    @staticmethod
+    def write_arrays(file_name, points, triangles, binary=True, mesh_io=None):
+        """Write (N, 3) points and (M, 3) triangle point ids to an STL file.
+
+        The arrays are only converted when they are not already C-contiguous
+        float32 points and uint32 or uint64 triangles. A configured
+        STLMeshIO can be passed as mesh_io to use its writing options.
+        """
+        import numpy as np
+
+        points = np.ascontiguousarray(points, dtype=np.float32)
+        triangles = np.ascontiguousarray(triangles)
+        if triangles.dtype not in (np.dtype(np.uint32), np.dtype(np.uint64)):
+            triangles = triangles.astype(np.uint64)
+        if points.ndim != 2 or points.shape[1] != 3 or triangles.ndim != 2 or triangles.shape[1] != 3:
+            raise ValueError("points and triangles must be arrays of shape (N, 3) and (M, 3)")
+        if triangles.size and triangles.max() >= len(points):
+            raise ValueError("triangles refer to points that do not exist")
+
+        if mesh_io is None:
+            mesh_io = itkSTLMeshIO.New()
+        mesh_io.SetFileName(str(file_name))
+        if binary:
+            mesh_io.SetFileTypeAsBINARY()
+        else:
+            mesh_io.SetFileTypeAsASCII()
+        mesh_io._WriteArrays(points, triangles)
+  %}
+}
@@ -0,0 +1,63 @@
+# ==========================================================================
+#
+#   Copyright NumFOCUS
+#
+#   Licensed under the Apache License, Version 2.0 (the "License");
+#   you may not use this file except in compliance with the License.
+#   You may obtain a copy of the License at
+#
+#          https://www.apache.org/licenses/LICENSE-2.0.txt
+#
+#   Unless required by applicable law or agreed to in writing, software
+#   distributed under the License is distributed on an "AS IS" BASIS,
+#   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#   See the License for the specific language governing permissions and
+#   limitations under the License.
+#
+# ==========================================================================
+
+import sys
+
+import itk
+import numpy as np
+
+if len(sys.argv) < 2:
+    print("Usage: " + sys.argv[0] + " outputPrefix")
+    sys.exit(1)
+
+file_name = sys.argv[1] + ".tetrahedron.stl"
+
+points = np.array([[0, 0, 0], [1, 0, 0], [0, 1, 0], [0, 0, 1]], dtype=np.float32)
+triangles = np.array([[0, 2, 1], [0, 1, 3], [0, 3, 2], [1, 2, 3]], dtype=np.uint32)
+
+itk.STLMeshIO.write_arrays(file_name, points, triangles)
+
+
+def check_arrays(read_points, read_triangles, points_dtype, index_dtype):
+    assert read_points.dtype == points_dtype, read_points.dtype
+    assert read_triangles.dtype == index_dtype, read_triangles.dtype
+    assert read_points.shape == points.shape, read_points.shape
+    assert read_triangles.shape == triangles.shape, read_triangles.shape
+
+    # The triangles keep their order and their vertices, whatever the ids
+    # given to the welded points.
+    np.testing.assert_array_equal(read_points[read_triangles], points[triangles])
+
+
+# Binary files are decoded by ReadMeshInformation(), or with DeferParsing by
+# the read of the points, once the arrays of the upper bounds are allocated:
+# the arrays returned hold only the points and triangles of the mesh.
+for defer_parsing in (False, True):
+    mesh_io = itk.STLMeshIO.New()
+    mesh_io.SetDeferParsing(defer_parsing)
+    check_arrays(*itk.STLMeshIO.read_arrays(file_name, mesh_io=mesh_io), np.float32, np.uint32)
+
+    # Points read as DOUBLE are returned as float64.
+    mesh_io = itk.STLMeshIO.New()
+    mesh_io.SetDeferParsing(defer_parsing)
+    mesh_io.SetPointComponentType(itk.CommonEnums.IOComponent_DOUBLE)
+    check_arrays(
+        *itk.STLMeshIO.read_arrays(file_name, index_dtype="uint64", mesh_io=mesh_io),
+        np.float64,
+        np.uint64,
+    )